@@ -1,5 +1,35 @@
 #include "KittyIOFile.hpp"
 
+#if defined(__ANDROID__) && __ANDROID_API__ < 24
+#include <sys/syscall.h>
+// preadv & pwritev are only exported by bionic since API 24
+static ssize_t call_preadv(int fd, const struct iovec *iov, int iovcnt, uint64_t offset)
+{
+#ifdef __LP64__
+    return syscall(__NR_preadv, fd, iov, iovcnt, long(offset), 0L);
+#else
+    return syscall(__NR_preadv, fd, iov, iovcnt, long(offset & 0xffffffff), long(offset >> 32));
+#endif
+}
+static ssize_t call_pwritev(int fd, const struct iovec *iov, int iovcnt, uint64_t offset)
+{
+#ifdef __LP64__
+    return syscall(__NR_pwritev, fd, iov, iovcnt, long(offset), 0L);
+#else
+    return syscall(__NR_pwritev, fd, iov, iovcnt, long(offset & 0xffffffff), long(offset >> 32));
+#endif
+}
+#else
+static ssize_t call_preadv(int fd, const struct iovec *iov, int iovcnt, uint64_t offset)
+{
+    return preadv64(fd, iov, iovcnt, offset);
+}
+static ssize_t call_pwritev(int fd, const struct iovec *iov, int iovcnt, uint64_t offset)
+{
+    return pwritev64(fd, iov, iovcnt, offset);
+}
+#endif
+
 bool KittyIOFile::Open()
 {
     if (_fd <= 0)
@@ -70,6 +100,24 @@ ssize_t KittyIOFile::Write(uintptr_t offset, const void *buffer, size_t len)
     return bytesWritten;
 }
 
+ssize_t KittyIOFile::ReadV(uintptr_t offset, const struct iovec *iov, int iovcnt)
+{
+    errno = 0, _error = 0;
+    ssize_t readSize = KT_EINTR_RETRY(call_preadv(_fd, iov, iovcnt, offset));
+    if (readSize < 0)
+        _error = errno;
+    return readSize;
+}
+
+ssize_t KittyIOFile::WriteV(uintptr_t offset, const struct iovec *iov, int iovcnt)
+{
+    errno = 0, _error = 0;
+    ssize_t writeSize = KT_EINTR_RETRY(call_pwritev(_fd, iov, iovcnt, offset));
+    if (writeSize < 0)
+        _error = errno;
+    return writeSize;
+}
+
 struct stat64 KittyIOFile::Stat()
 {
     errno = 0, _error = 0;
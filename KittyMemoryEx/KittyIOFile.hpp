@@ -42,6 +42,16 @@ public:
     ssize_t Read(uintptr_t offset, void *buffer, size_t len);
     ssize_t Write(uintptr_t offset, const void *buffer, size_t len);
 
+    /**
+     * Single preadv call, returns bytes read or -1
+     */
+    ssize_t ReadV(uintptr_t offset, const struct iovec *iov, int iovcnt);
+
+    /**
+     * Single pwritev call, returns bytes written or -1
+     */
+    ssize_t WriteV(uintptr_t offset, const struct iovec *iov, int iovcnt);
+
     inline bool Exists() { return access(_filePath.c_str(), F_OK) != -1; }
 
     inline bool canRead() { return access(_filePath.c_str(), R_OK) != -1; }
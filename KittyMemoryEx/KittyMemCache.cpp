@@ -0,0 +1,343 @@
+#include "KittyMemCache.hpp"
+
+KittyMemCache::KittyMemCache(std::unique_ptr<IKittyMemOp> backend, size_t maxPages, size_t maxReadPages)
+    : _pBackend(std::move(backend)), _pageSize(KT_PAGE_SIZE), _maxPages(std::max(maxPages, size_t(1))),
+      _maxReadPages(maxReadPages), _epoch(0), _hits(0), _misses(0), _pageMapGeneration(0)
+{
+}
+
+bool KittyMemCache::init(pid_t pid)
+{
+    if (!_pBackend.get())
+    {
+        KITTY_LOGE("KittyMemCache: No backend memory operation.");
+        return false;
+    }
+
+    invalidateAll();
+    resetStats();
+
+    if (!_pBackend->init(pid))
+        return false;
+
+    _pid = pid;
+    return true;
+}
+
+bool KittyMemCache::lookupPage(uintptr_t page, const char **data) const
+{
+    auto it = _pages.find(page);
+    if (it == _pages.end())
+        return false;
+
+    // stale, drop it
+    if (it->second->epoch != _epoch.load())
+    {
+        _lru.erase(it->second);
+        _pages.erase(it);
+        return false;
+    }
+
+    _lru.splice(_lru.begin(), _lru, it->second);
+    *data = it->second->data.data();
+    return true;
+}
+
+void KittyMemCache::insertPage(uintptr_t page, const char *data) const
+{
+    auto it = _pages.find(page);
+    if (it != _pages.end())
+    {
+        // another thread fetched it meanwhile, refresh
+        memcpy(it->second->data.data(), data, _pageSize);
+        it->second->epoch = _epoch.load();
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return;
+    }
+
+    if (_pages.size() >= _maxPages && !_lru.empty())
+    {
+        // reuse least recently used page storage
+        auto last = std::prev(_lru.end());
+        _pages.erase(last->address);
+        _lru.splice(_lru.begin(), _lru, last);
+    }
+    else
+    {
+        _lru.emplace_front();
+        _lru.front().data.resize(_pageSize);
+    }
+
+    page_t &front = _lru.front();
+    front.address = page;
+    front.epoch = _epoch.load();
+    memcpy(front.data.data(), data, _pageSize);
+    _pages[page] = _lru.begin();
+}
+
+size_t KittyMemCache::Read(uintptr_t address, void *buffer, size_t len) const
+{
+    mem_request_t req(address, buffer, len);
+    return ReadBatch(&req, 1);
+}
+
+size_t KittyMemCache::Write(uintptr_t address, void *buffer, size_t len) const
+{
+    if (!_pBackend.get())
+        return 0;
+
+    size_t n = _pBackend->Write(address, buffer, len);
+    invalidate(address, len);
+    return n;
+}
+
+size_t KittyMemCache::ReadBatch(mem_request_t *requests, size_t count) const
+{
+    if (_pid < 1 || !_pBackend.get() || !requests || !count)
+        return 0;
+
+    const uintptr_t page_size = _pageSize;
+
+    // copy a page slice into a request
+    auto copy_slice = [&](mem_request_t &req, uintptr_t page, const char *data)
+    {
+        uintptr_t start = std::max(req.address, page);
+        uintptr_t end = std::min(req.address + req.len, page + page_size);
+        memcpy(reinterpret_cast<char *>(req.buffer) + (start - req.address), data + (start - page), end - start);
+        req.result += end - start;
+    };
+
+    auto is_cacheable = [&](const mem_request_t &req)
+    {
+        return ((KT_PAGE_END(req.address + req.len) - KT_PAGE_START(req.address)) / page_size) <= _maxReadPages;
+    };
+
+    std::vector<mem_request_t> direct;
+    std::vector<size_t> direct_idx;
+    std::vector<uintptr_t> missing;
+
+    // serve cached pages and collect the missing ones
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < count; i++)
+        {
+            mem_request_t &req = requests[i];
+            req.result = 0;
+            if (!req.address || !req.buffer || !req.len)
+                continue;
+
+            if (!is_cacheable(req))
+            {
+                direct.emplace_back(req.address, req.buffer, req.len);
+                direct_idx.push_back(i);
+                continue;
+            }
+
+            for (uintptr_t page = KT_PAGE_START(req.address); page < req.address + req.len; page += page_size)
+            {
+                const char *data = nullptr;
+                if (lookupPage(page, &data))
+                {
+                    copy_slice(req, page, data);
+                    _hits++;
+                }
+                else
+                {
+                    missing.push_back(page);
+                }
+            }
+        }
+    }
+
+    size_t bytes_read = 0;
+
+    if (!missing.empty())
+    {
+        std::sort(missing.begin(), missing.end());
+        missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+        _misses += missing.size();
+
+        // fetch missing pages, adjacent pages share one request
+        std::vector<char> fetched(missing.size() * page_size);
+        std::vector<mem_request_t> runs;
+        std::vector<size_t> run_first;
+        for (size_t i = 0; i < missing.size(); i++)
+        {
+            if (i > 0 && missing[i] == missing[i - 1] + page_size)
+            {
+                runs.back().len += page_size;
+                continue;
+            }
+
+            runs.emplace_back(missing[i], &fetched[i * page_size], page_size);
+            run_first.push_back(i);
+        }
+
+        _pBackend->ReadBatch(runs);
+
+        std::vector<bool> valid(missing.size(), false);
+        for (size_t r = 0; r < runs.size(); r++)
+        {
+            size_t first = run_first[r], npages = runs[r].len / page_size;
+            if (runs[r].result == runs[r].len)
+            {
+                std::fill(valid.begin() + first, valid.begin() + first + npages, true);
+                continue;
+            }
+
+            // partial run, find out exactly which pages are readable
+            for (size_t p = first; p < first + npages; p++)
+                valid[p] = _pBackend->Read(missing[p], &fetched[p * page_size], page_size) == page_size;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (size_t p = 0; p < missing.size(); p++)
+            {
+                if (valid[p])
+                    insertPage(missing[p], &fetched[p * page_size]);
+            }
+        }
+
+        // serve fetched pages from local copy since they may already be evicted
+        for (size_t i = 0; i < count; i++)
+        {
+            mem_request_t &req = requests[i];
+            if (!req.address || !req.buffer || !req.len || !is_cacheable(req))
+                continue;
+
+            for (uintptr_t page = KT_PAGE_START(req.address); page < req.address + req.len; page += page_size)
+            {
+                auto it = std::lower_bound(missing.begin(), missing.end(), page);
+                if (it == missing.end() || *it != page)
+                    continue;
+
+                size_t p = it - missing.begin();
+                if (valid[p])
+                    copy_slice(req, page, &fetched[p * page_size]);
+            }
+        }
+    }
+
+    if (!direct.empty())
+    {
+        _pBackend->ReadBatch(direct);
+        for (size_t i = 0; i < direct.size(); i++)
+            requests[direct_idx[i]].result = direct[i].result;
+    }
+
+    for (size_t i = 0; i < count; i++)
+        bytes_read += requests[i].result;
+
+    return bytes_read;
+}
+
+size_t KittyMemCache::WriteBatch(mem_request_t *requests, size_t count) const
+{
+    if (!_pBackend.get() || !requests || !count)
+        return 0;
+
+    size_t n = _pBackend->WriteBatch(requests, count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (requests[i].address && requests[i].len)
+            invalidate(requests[i].address, requests[i].len);
+    }
+    return n;
+}
+
+void KittyMemCache::invalidate(uintptr_t address, size_t len) const
+{
+    if (!len)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // large range, cheaper to walk cached pages
+    if (len / _pageSize > _pages.size())
+    {
+        const uintptr_t start = KT_PAGE_START(address), end = address + len;
+        for (auto it = _lru.begin(); it != _lru.end();)
+        {
+            if (it->address >= start && it->address < end)
+            {
+                _pages.erase(it->address);
+                it = _lru.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return;
+    }
+
+    for (uintptr_t page = KT_PAGE_START(address); page < address + len; page += _pageSize)
+    {
+        auto it = _pages.find(page);
+        if (it != _pages.end())
+        {
+            _lru.erase(it->second);
+            _pages.erase(it);
+        }
+    }
+}
+
+size_t KittyMemCache::invalidateDirty(KittyPageMap *pageMap)
+{
+    if (!pageMap || !pageMap->isValid())
+        return 0;
+
+    std::vector<uintptr_t> pages;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        pages.reserve(_pages.size());
+        for (auto &it : _lru)
+            pages.push_back(it.address);
+    }
+
+    std::vector<bool> keep;
+    if (_pageMapGeneration && _pageMapGeneration == pageMap->generation() && !pages.empty())
+    {
+        std::sort(pages.begin(), pages.end());
+        std::vector<uint64_t> entries(pages.size());
+        pageMap->readEntries(pages.data(), pages.size(), entries.data());
+
+        keep.resize(pages.size());
+        for (size_t i = 0; i < pages.size(); i++)
+            keep[i] = KittyPageMap::isClean(entries[i]);
+    }
+
+    _pageMapGeneration = pageMap->clearSoftDirty();
+
+    // pages cached after the entries were read may have been written before the clear, drop them too
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t dropped = 0;
+    for (auto it = _lru.begin(); it != _lru.end();)
+    {
+        auto p = std::lower_bound(pages.begin(), pages.end(), it->address);
+        if (!keep.empty() && p != pages.end() && *p == it->address && keep[p - pages.begin()])
+        {
+            ++it;
+            continue;
+        }
+
+        _pages.erase(it->address);
+        it = _lru.erase(it);
+        dropped++;
+    }
+    return dropped;
+}
+
+void KittyMemCache::invalidateAll() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pages.clear();
+    _lru.clear();
+}
+
+size_t KittyMemCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pages.size();
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "KittyUtils.hpp"
+#include "KittyMemOp.hpp"
+#include "KittyPageMap.hpp"
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+/**
+ * Page granular LRU read cache over any IKittyMemOp
+ * Writes made through the cache invalidate the written pages,
+ * writes made by other means need invalidate() or nextEpoch()
+ */
+class KittyMemCache : public IKittyMemOp
+{
+private:
+    struct page_t
+    {
+        uintptr_t address = 0;
+        uint32_t epoch = 0;
+        std::vector<char> data;
+    };
+
+    std::unique_ptr<IKittyMemOp> _pBackend;
+    size_t _pageSize;
+    size_t _maxPages;
+    size_t _maxReadPages;
+
+    mutable std::mutex _mutex;
+    mutable std::list<page_t> _lru; // front is most recently used
+    mutable std::unordered_map<uintptr_t, std::list<page_t>::iterator> _pages;
+    std::atomic<uint32_t> _epoch;
+
+    mutable std::atomic<size_t> _hits, _misses;
+
+    uint32_t _pageMapGeneration; // soft-dirty generation cleared by the last invalidateDirty()
+
+    // sets data to the cached page if present and current, must hold _mutex
+    bool lookupPage(uintptr_t page, const char **data) const;
+    // must hold _mutex
+    void insertPage(uintptr_t page, const char *data) const;
+
+public:
+    using IKittyMemOp::ReadBatch;
+    using IKittyMemOp::WriteBatch;
+
+    /**
+     * @param backend: memory operation to cache, initialized by init()
+     * @param maxPages: maximum number of cached pages
+     * @param maxReadPages: reads spanning more pages than this bypass the cache
+     */
+    KittyMemCache(std::unique_ptr<IKittyMemOp> backend, size_t maxPages = 4096, size_t maxReadPages = 16);
+
+    bool init(pid_t pid);
+
+    size_t Read(uintptr_t address, void *buffer, size_t len) const;
+    size_t Write(uintptr_t address, void *buffer, size_t len) const;
+
+    // serves cached pages and fetches all missing pages with one backend ReadBatch
+    size_t ReadBatch(mem_request_t *requests, size_t count) const;
+    size_t WriteBatch(mem_request_t *requests, size_t count) const;
+
+    inline IKittyMemOp *backend() const { return _pBackend.get(); }
+
+    inline size_t maxPages() const { return _maxPages; }
+    inline size_t maxReadPages() const { return _maxReadPages; }
+
+    /**
+     * Drop cached pages overlapping range
+     */
+    void invalidate(uintptr_t address, size_t len) const;
+
+    /**
+     * Drop all cached pages
+     */
+    void invalidateAll() const;
+
+    /**
+     * Drop only cached pages written since the previous call using soft-dirty bits, then clear them
+     * drops everything when soft-dirty is unavailable or another user cleared in between
+     * @return number of dropped pages
+     */
+    size_t invalidateDirty(KittyPageMap *pageMap);
+
+    /**
+     * Current cache epoch, pages cached in older epochs are stale
+     */
+    inline uint32_t epoch() const { return _epoch.load(); }
+
+    /**
+     * Start a new epoch, all currently cached pages become stale
+     * cheaper than invalidateAll() as stale pages are dropped lazily
+     */
+    inline uint32_t nextEpoch() { return ++_epoch; }
+
+    inline size_t hits() const { return _hits.load(); }
+    inline size_t misses() const { return _misses.load(); }
+    inline void resetStats() { _hits = 0, _misses = 0; }
+
+    /**
+     * Number of currently cached pages, including stale ones
+     */
+    size_t size() const;
+};
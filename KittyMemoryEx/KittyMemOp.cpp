@@ -18,6 +18,10 @@
 #error "Unsupported ABI"
 #endif
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
 static ssize_t call_process_vm_readv(pid_t pid,
                                      const iovec *lvec, unsigned long liovcnt,
                                      const iovec *rvec, unsigned long riovcnt,
@@ -36,6 +40,104 @@ static ssize_t call_process_vm_writev(pid_t pid,
 
 /* =================== IKittyMemOp =================== */
 
+size_t IKittyMemOp::ReadMapped(uintptr_t address, void *buffer, size_t len,
+                               const std::vector<KittyMemoryEx::ProcMap> &maps, std::vector<bool> *readablePages) const
+{
+    if (readablePages)
+        readablePages->clear();
+
+    if (_pid < 1 || !address || !buffer || !len)
+        return 0;
+
+    const uintptr_t page_size = KT_PAGE_SIZE;
+    const uintptr_t end = address + len;
+    const uintptr_t first_page = KT_PAGE_START(address);
+
+    if (readablePages)
+        readablePages->assign((KT_PAGE_END(end) - first_page) / page_size, false);
+
+    auto local = [&](uintptr_t remote) { return reinterpret_cast<char *>(buffer) + (remote - address); };
+
+    // maps are page aligned so any page overlapping [start, stop) was fully read
+    auto mark_pages = [&](uintptr_t start, uintptr_t stop)
+    {
+        if (!readablePages || start >= stop)
+            return;
+
+        for (uintptr_t page = KT_PAGE_START(start); page < stop; page += page_size)
+            (*readablePages)[(page - first_page) / page_size] = true;
+    };
+
+    size_t bytes_read = 0;
+    uintptr_t cursor = address;
+    for (auto &it : maps)
+    {
+        if (it.endAddress <= cursor)
+            continue;
+
+        if (it.startAddress >= end)
+            break;
+
+        uintptr_t seg_start = std::max(cursor, uintptr_t(it.startAddress));
+        uintptr_t seg_end = std::min(end, uintptr_t(it.endAddress));
+
+        // unmapped gap before this map
+        if (seg_start > cursor)
+            memset(local(cursor), 0, seg_start - cursor);
+
+        cursor = seg_end;
+
+        if (!it.readable)
+        {
+            memset(local(seg_start), 0, seg_end - seg_start);
+            continue;
+        }
+
+        size_t seg_len = seg_end - seg_start;
+        size_t n = Read(seg_start, local(seg_start), seg_len);
+        if (n == seg_len)
+        {
+            bytes_read += n;
+            mark_pages(seg_start, seg_end);
+            continue;
+        }
+
+        // map is readable but parts of it are not (ex: file mapped beyond EOF)
+        // redo it page by page to know exactly which pages were read
+        for (uintptr_t pg = seg_start; pg < seg_end;)
+        {
+            size_t pg_len = std::min(size_t(KT_PAGE_END(pg + 1) - pg), size_t(seg_end - pg));
+            if (Read(pg, local(pg), pg_len) == pg_len)
+            {
+                bytes_read += pg_len;
+                mark_pages(pg, pg + pg_len);
+            }
+            else
+            {
+                memset(local(pg), 0, pg_len);
+            }
+            pg += pg_len;
+        }
+    }
+
+    // unmapped tail
+    if (cursor < end)
+        memset(local(cursor), 0, end - cursor);
+
+    return bytes_read;
+}
+
+size_t IKittyMemOp::ReadMapped(uintptr_t address, void *buffer, size_t len, std::vector<bool> *readablePages) const
+{
+    if (readablePages)
+        readablePages->clear();
+
+    if (_pid < 1 || !address || !buffer || !len)
+        return 0;
+
+    return ReadMapped(address, buffer, len, KittyMemoryEx::getAllMaps(_pid), readablePages);
+}
+
 std::string IKittyMemOp::ReadStr(uintptr_t address, size_t maxLen)
 {
     std::vector<char> chars(maxLen);
@@ -64,6 +166,34 @@ bool IKittyMemOp::WriteStr(uintptr_t address, std::string str)
     return Write(address, &str[0], len) == len;
 }
 
+size_t IKittyMemOp::ReadBatch(mem_request_t *requests, size_t count) const
+{
+    if (!requests || !count)
+        return 0;
+
+    size_t bytes_read = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        requests[i].result = Read(requests[i].address, requests[i].buffer, requests[i].len);
+        bytes_read += requests[i].result;
+    }
+    return bytes_read;
+}
+
+size_t IKittyMemOp::WriteBatch(mem_request_t *requests, size_t count) const
+{
+    if (!requests || !count)
+        return 0;
+
+    size_t bytes_written = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        requests[i].result = Write(requests[i].address, requests[i].buffer, requests[i].len);
+        bytes_written += requests[i].result;
+    }
+    return bytes_written;
+}
+
 /* =================== KittyMemSys =================== */
 
 bool KittyMemSys::init(pid_t pid)
@@ -214,6 +344,85 @@ size_t KittyMemSys::Write(uintptr_t address, void *buffer, size_t len) const
     return bytes_written;
 }
 
+size_t KittyMemSys::ReadBatch(mem_request_t *requests, size_t count) const
+{
+    return vm_batch(requests, count, false);
+}
+
+size_t KittyMemSys::WriteBatch(mem_request_t *requests, size_t count) const
+{
+    return vm_batch(requests, count, true);
+}
+
+size_t KittyMemSys::vm_batch(mem_request_t *requests, size_t count, bool write) const
+{
+    if (_pid < 1 || !requests || !count)
+        return 0;
+
+    const size_t max_iov = std::min(count, size_t(IOV_MAX));
+    std::vector<iovec> lvecs, rvecs;
+    std::vector<size_t> packed;
+    lvecs.reserve(max_iov);
+    rvecs.reserve(max_iov);
+    packed.reserve(max_iov);
+
+    size_t bytes = 0, i = 0;
+    while (i < count)
+    {
+        lvecs.clear();
+        rvecs.clear();
+        packed.clear();
+
+        for (; i < count && packed.size() < max_iov; i++)
+        {
+            mem_request_t &req = requests[i];
+            req.result = 0;
+            if (!req.address || !req.buffer || !req.len)
+                continue;
+
+            lvecs.push_back({ .iov_base = req.buffer, .iov_len = req.len });
+            rvecs.push_back({ .iov_base = reinterpret_cast<void*>(req.address), .iov_len = req.len });
+            packed.push_back(i);
+        }
+
+        if (packed.empty())
+            break;
+
+        errno = 0;
+        ssize_t n = write ? KT_EINTR_RETRY(call_process_vm_writev(_pid, lvecs.data(), lvecs.size(), rvecs.data(), rvecs.size(), 0))
+                          : KT_EINTR_RETRY(call_process_vm_readv(_pid, lvecs.data(), lvecs.size(), rvecs.data(), rvecs.size(), 0));
+        if (n == -1 && (errno == EPERM || errno == ESRCH))
+        {
+            KITTY_LOGE("Failed %s batch of %zu | Can't access process ID (%d), error: %s.",
+                write ? "vm_writev" : "vm_readv", packed.size(), _pid, strerror(errno));
+            // requests past this chunk were never reached, don't leave results of a previous use
+            for (; i < count; i++)
+                requests[i].result = 0;
+            break;
+        }
+
+        size_t done = n > 0 ? size_t(n) : 0, k = 0;
+        for (; k < packed.size() && done >= requests[packed[k]].len; k++)
+        {
+            mem_request_t &req = requests[packed[k]];
+            req.result = req.len;
+            done -= req.len;
+            bytes += req.len;
+        }
+
+        // transfer stopped at this request, redo it alone with page fallback
+        // then resume batching from the one after it
+        if (k < packed.size())
+        {
+            mem_request_t &req = requests[packed[k]];
+            req.result = write ? Write(req.address, req.buffer, req.len) : Read(req.address, req.buffer, req.len);
+            bytes += req.result;
+            i = packed[k] + 1;
+        }
+    }
+    return bytes;
+}
+
 /* =================== KittyMemIO =================== */
 
 bool KittyMemIO::init(pid_t pid)
@@ -254,4 +463,74 @@ size_t KittyMemIO::Write(uintptr_t address, void *buffer, size_t len) const
 
     ssize_t bytes = _pMem->Write(address, buffer, len);
     return bytes > 0 ? bytes : 0;
+}
+
+size_t KittyMemIO::ReadBatch(mem_request_t *requests, size_t count) const
+{
+    return io_batch(requests, count, false);
+}
+
+size_t KittyMemIO::WriteBatch(mem_request_t *requests, size_t count) const
+{
+    return io_batch(requests, count, true);
+}
+
+size_t KittyMemIO::io_batch(mem_request_t *requests, size_t count, bool write) const
+{
+    if (_pid < 1 || !requests || !count || !_pMem.get())
+        return 0;
+
+    // sort by address so adjacent ranges can share one preadv / pwritev
+    std::vector<size_t> order;
+    order.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        requests[i].result = 0;
+        if (requests[i].address && requests[i].buffer && requests[i].len)
+            order.push_back(i);
+    }
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    { return requests[a].address < requests[b].address; });
+
+    std::vector<iovec> iovs;
+    iovs.reserve(std::min(order.size(), size_t(IOV_MAX)));
+
+    size_t bytes = 0, i = 0;
+    while (i < order.size())
+    {
+        iovs.clear();
+
+        const uintptr_t group_start = requests[order[i]].address;
+        uintptr_t group_end = group_start;
+        size_t j = i;
+        for (; j < order.size() && iovs.size() < size_t(IOV_MAX); j++)
+        {
+            mem_request_t &req = requests[order[j]];
+            if (req.address != group_end)
+                break;
+
+            iovs.push_back({ .iov_base = req.buffer, .iov_len = req.len });
+            group_end += req.len;
+        }
+
+        ssize_t n = write ? _pMem->WriteV(group_start, iovs.data(), int(iovs.size()))
+                          : _pMem->ReadV(group_start, iovs.data(), int(iovs.size()));
+        size_t done = n > 0 ? size_t(n) : 0;
+        for (; i < j; i++)
+        {
+            mem_request_t &req = requests[order[i]];
+            req.result = std::min(done, req.len);
+            done -= req.result;
+            bytes += req.result;
+
+            // rest of the group is behind the failed range, start a new group after it
+            if (req.result != req.len)
+            {
+                i++;
+                break;
+            }
+        }
+    }
+    return bytes;
 }
\ No newline at end of file
@@ -2,12 +2,33 @@
 
 #include "KittyUtils.hpp"
 #include "KittyIOFile.hpp"
+#include "KittyMemoryEx.hpp"
 
 enum EKittyMemOP
 {
     EK_MEM_OP_NONE = 0,
     EK_MEM_OP_SYSCALL,
-    EK_MEM_OP_IO
+    EK_MEM_OP_IO,
+    EK_MEM_OP_SYSCALL_CACHE, // EK_MEM_OP_SYSCALL with KittyMemCache
+    EK_MEM_OP_IO_CACHE       // EK_MEM_OP_IO with KittyMemCache
+};
+
+/**
+ * A single remote range for ReadBatch / WriteBatch
+ * result is set to the number of bytes transferred for this range,
+ * once a range falls back to page by page access it counts pages that may not be adjacent,
+ * so result < len is not a readable prefix and skipped bytes are left untouched in buffer,
+ * zero buffers before reading or use ReadMapped when you need to know which pages were read
+ */
+struct mem_request_t
+{
+    uintptr_t address = 0;
+    void *buffer = nullptr;
+    size_t len = 0;
+    size_t result = 0;
+
+    mem_request_t() : address(0), buffer(nullptr), len(0), result(0) {}
+    mem_request_t(uintptr_t a, void *b, size_t l) : address(a), buffer(b), len(l), result(0) {}
 };
 
 class IKittyMemOp
@@ -26,17 +47,64 @@ public:
     virtual size_t Read(uintptr_t address, void *buffer, size_t len) const = 0;
     virtual size_t Write(uintptr_t address, void *buffer, size_t len) const = 0;
 
+    /**
+     * Read multiple remote ranges, result of each request is set to its bytes read
+     * a partial result is not a prefix, see mem_request_t
+     * @return total bytes read
+     */
+    virtual size_t ReadBatch(mem_request_t *requests, size_t count) const;
+    inline size_t ReadBatch(std::vector<mem_request_t> &requests) const
+    {
+        return ReadBatch(requests.data(), requests.size());
+    }
+
+    /**
+     * Write multiple remote ranges, result of each request is set to its bytes written
+     * @return total bytes written
+     */
+    virtual size_t WriteBatch(mem_request_t *requests, size_t count) const;
+    inline size_t WriteBatch(std::vector<mem_request_t> &requests) const
+    {
+        return WriteBatch(requests.data(), requests.size());
+    }
+
+    /**
+     * Read a range while skipping whole unreadable regions instead of retrying page by page
+     * unreadable and unmapped parts of the range are zero filled
+     * @param maps: maps snapshot sorted by address (as returned by getAllMaps)
+     * @param readablePages: optional, set to one bit per page starting at KT_PAGE_START(address), true if page was read
+     * @return total bytes read
+     */
+    size_t ReadMapped(uintptr_t address, void *buffer, size_t len,
+                      const std::vector<KittyMemoryEx::ProcMap> &maps, std::vector<bool> *readablePages = nullptr) const;
+
+    /**
+     * ReadMapped with a maps snapshot taken once for this call
+     */
+    size_t ReadMapped(uintptr_t address, void *buffer, size_t len, std::vector<bool> *readablePages = nullptr) const;
+
     std::string ReadStr(uintptr_t address, size_t maxLen);
     bool WriteStr(uintptr_t address, std::string str);
 };
 
 class KittyMemSys : public IKittyMemOp
 {
+private:
+    size_t vm_batch(mem_request_t *requests, size_t count, bool write) const;
+
 public:
+    using IKittyMemOp::ReadBatch;
+    using IKittyMemOp::WriteBatch;
+
     bool init(pid_t pid);
 
     size_t Read(uintptr_t address, void *buffer, size_t len) const;
     size_t Write(uintptr_t address, void *buffer, size_t len) const;
+
+    // packs up to IOV_MAX requests per process_vm_readv call
+    size_t ReadBatch(mem_request_t *requests, size_t count) const;
+    // packs up to IOV_MAX requests per process_vm_writev call
+    size_t WriteBatch(mem_request_t *requests, size_t count) const;
 };
 
 class KittyMemIO : public IKittyMemOp
@@ -44,9 +112,19 @@ class KittyMemIO : public IKittyMemOp
 private:
     std::unique_ptr<KittyIOFile> _pMem;
 
+    size_t io_batch(mem_request_t *requests, size_t count, bool write) const;
+
 public:
+    using IKittyMemOp::ReadBatch;
+    using IKittyMemOp::WriteBatch;
+
     bool init(pid_t pid);
 
     size_t Read(uintptr_t address, void *buffer, size_t len) const;
     size_t Write(uintptr_t address, void *buffer, size_t len) const;
+
+    // coalesces adjacent requests into a single preadv call
+    size_t ReadBatch(mem_request_t *requests, size_t count) const;
+    // coalesces adjacent requests into a single pwritev call
+    size_t WriteBatch(mem_request_t *requests, size_t count) const;
 };
\ No newline at end of file
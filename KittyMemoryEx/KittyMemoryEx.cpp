@@ -89,67 +89,166 @@ namespace KittyMemoryEx
         return retVal;
     }
 
-    std::vector<ProcMap> getAllMaps(pid_t pid)
+    static inline unsigned long long parseHex(const char *&p, const char *end)
     {
-        std::vector<ProcMap> retMaps;
-        if (pid <= 0)
-            return retMaps;
+        unsigned long long v = 0;
+        for (; p < end; ++p)
+        {
+            unsigned c = (unsigned char)*p;
+            if (c - '0' < 10)
+                v = (v << 4) | (c - '0');
+            else if ((c | 0x20) - 'a' < 6)
+                v = (v << 4) | ((c | 0x20) - 'a' + 10);
+            else
+                break;
+        }
+        return v;
+    }
+
+    static inline unsigned long parseDec(const char *&p, const char *end)
+    {
+        unsigned long v = 0;
+        for (; p < end && unsigned((unsigned char)*p - '0') < 10; ++p)
+            v = v * 10 + (*p - '0');
+        return v;
+    }
+
+    static inline void skipSpaces(const char *&p, const char *end)
+    {
+        while (p < end && *p == ' ')
+            ++p;
+    }
+
+    // parse a line in maps file without the trailing new line
+    // (format) startAddress-endAddress perms offset dev inode pathname
+    static bool parseMapsLine(const char *p, const char *end, pid_t pid, ProcMap *map)
+    {
+        map->pid = pid;
+
+        map->startAddress = parseHex(p, end);
+        if (p >= end || *p++ != '-')
+            return false;
 
+        map->endAddress = parseHex(p, end);
+        skipSpaces(p, end);
+
+        if (end - p < 4)
+            return false;
+
+        const char *perms = p;
+        p += 4;
+
+        skipSpaces(p, end);
+        map->offset = parseHex(p, end);
+        skipSpaces(p, end);
+
+        const char *dev = p;
+        while (p < end && *p != ' ')
+            ++p;
+        map->dev.assign(dev, p - dev);
+
+        skipSpaces(p, end);
+        map->inode = parseDec(p, end);
+        skipSpaces(p, end);
+
+        map->pathname.assign(p, end - p);
+
+        map->length = map->endAddress - map->startAddress;
+
+        if (perms[0] == 'r')
+        {
+            map->protection |= PROT_READ;
+            map->readable = true;
+        }
+        if (perms[1] == 'w')
+        {
+            map->protection |= PROT_WRITE;
+            map->writeable = true;
+        }
+        if (perms[2] == 'x')
+        {
+            map->protection |= PROT_EXEC;
+            map->executable = true;
+        }
+
+        map->is_private = (perms[3] == 'p');
+        map->is_shared = (perms[3] == 's');
+
+        map->is_rx = (strncmp(perms, "r-x", 3) == 0);
+        map->is_rw = (strncmp(perms, "rw-", 3) == 0);
+        map->is_ro = (strncmp(perms, "r--", 3) == 0);
+
+        return true;
+    }
+
+    // reads whole maps file in large blocks
+    static bool readMapsFile(pid_t pid, std::vector<char> *buf)
+    {
         char filePath[256] = {0};
         snprintf(filePath, sizeof(filePath), "/proc/%d/maps", pid);
 
         errno = 0;
-        FILE *fp = fopen(filePath, "r");
-        if (!fp)
+        int fd = KT_EINTR_RETRY(open(filePath, O_RDONLY | O_CLOEXEC));
+        if (fd < 0)
         {
             KITTY_LOGE("Couldn't open maps file %s, error=%s", filePath, strerror(errno));
-            return retMaps;
+            return false;
         }
 
-        char line[512] = {0};
-        while (fgets(line, sizeof(line), fp))
+        if (buf->size() < 64 * 1024)
+            buf->resize(64 * 1024);
+
+        size_t filled = 0;
+        ssize_t n = 0;
+        while ((n = KT_EINTR_RETRY(read(fd, buf->data() + filled, buf->size() - filled))) > 0)
         {
-            ProcMap map;
-            map.pid = pid;
+            filled += n;
+            if (filled == buf->size())
+                buf->resize(buf->size() * 2);
+        }
 
-            char perms[5] = {0}, dev[11] = {0}, pathname[256] = {0};
-            // parse a line in maps file
-            // (format) startAddress-endAddress perms offset dev inode pathname
-            sscanf(line, "%llx-%llx %s %llx %s %lu %s", 
-                   &map.startAddress, &map.endAddress,
-                   perms, &map.offset, dev, &map.inode, pathname);
+        close(fd);
+        buf->resize(filled);
+        return n == 0;
+    }
 
-            map.length = map.endAddress - map.startAddress;
-            map.dev = dev;
-            map.pathname = pathname;
+    static std::vector<ProcMap> parseMaps(pid_t pid, const char *data, size_t len)
+    {
+        std::vector<ProcMap> retMaps;
 
-            if (perms[0] == 'r')
-            {
-                map.protection |= PROT_READ;
-                map.readable = true;
-            }
-            if (perms[1] == 'w')
-            {
-                map.protection |= PROT_WRITE;
-                map.writeable = true;
-            }
-            if (perms[2] == 'x')
-            {
-                map.protection |= PROT_EXEC;
-                map.executable = true;
-            }
+        const char *end = data + len;
+        size_t lines = 0;
+        for (const char *p = data; (p = (const char *)memchr(p, '\n', end - p)) != nullptr; ++p)
+            lines++;
+
+        retMaps.reserve(lines + 1);
 
-            map.is_private = (perms[3] == 'p');
-            map.is_shared = (perms[3] == 's');
+        const char *line = data;
+        while (line < end)
+        {
+            const char *nl = (const char *)memchr(line, '\n', end - line);
+            if (!nl)
+                nl = end;
 
-            map.is_rx = (strncmp(perms, "r-x", 3) == 0);
-            map.is_rw = (strncmp(perms, "rw-", 3) == 0);
-            map.is_ro = (strncmp(perms, "r--", 3) == 0);
+            retMaps.emplace_back();
+            if (!parseMapsLine(line, nl, pid, &retMaps.back()))
+                retMaps.pop_back();
 
-            retMaps.push_back(map);
+            line = nl + 1;
         }
 
-        fclose(fp);
+        return retMaps;
+    }
+
+    std::vector<ProcMap> getAllMaps(pid_t pid)
+    {
+        std::vector<ProcMap> retMaps;
+        if (pid <= 0)
+            return retMaps;
+
+        std::vector<char> buf;
+        if (readMapsFile(pid, &buf))
+            retMaps = parseMaps(pid, buf.data(), buf.size());
 
         if (retMaps.empty())
         {
@@ -232,6 +331,201 @@ namespace KittyMemoryEx
         return getAddressMap(getAllMaps(pid), address);
     }
 
+    ProcMapIndex::ProcMapIndex(std::vector<ProcMap> maps) : _maps(std::move(maps))
+    {
+        // maps file is already sorted, this only matters for user provided maps
+        if (!std::is_sorted(_maps.begin(), _maps.end(), [](const ProcMap &a, const ProcMap &b)
+                            { return a.startAddress < b.startAddress; }))
+        {
+            std::sort(_maps.begin(), _maps.end(), [](const ProcMap &a, const ProcMap &b)
+                      { return a.startAddress < b.startAddress; });
+        }
+
+        for (size_t i = 0; i < _maps.size(); i++)
+        {
+            if (_maps[i].isValid() && !_maps[i].isUnknown())
+                _pathMaps[_maps[i].pathname].push_back(i);
+        }
+    }
+
+    const ProcMap *ProcMapIndex::find(uintptr_t address) const
+    {
+        if (_maps.empty() || !address)
+            return nullptr;
+
+        auto it = std::upper_bound(_maps.begin(), _maps.end(), address, [](uintptr_t a, const ProcMap &m)
+                                   { return a < m.startAddress; });
+        if (it == _maps.begin())
+            return nullptr;
+
+        --it;
+        return (it->isValid() && it->contains(address)) ? &(*it) : nullptr;
+    }
+
+    std::vector<const ProcMap *> ProcMapIndex::findBatch(const std::vector<uintptr_t> &addresses) const
+    {
+        std::vector<const ProcMap *> ret(addresses.size(), nullptr);
+        if (_maps.empty())
+            return ret;
+
+        size_t m = 0;
+        uintptr_t prev = 0;
+        for (size_t i = 0; i < addresses.size(); i++)
+        {
+            const uintptr_t address = addresses[i];
+            if (!address)
+                continue;
+
+            if (address < prev)
+            {
+                ret[i] = find(address);
+                continue;
+            }
+            prev = address;
+
+            while (m < _maps.size() && _maps[m].endAddress <= address)
+                m++;
+
+            if (m == _maps.size())
+                continue;
+
+            if (_maps[m].isValid() && _maps[m].contains(address))
+                ret[i] = &_maps[m];
+        }
+        return ret;
+    }
+
+    std::vector<ProcMap> ProcMapIndex::getMapsInRange(uintptr_t start, uintptr_t end) const
+    {
+        std::vector<ProcMap> retMaps;
+        if (_maps.empty() || end <= start)
+            return retMaps;
+
+        auto it = std::lower_bound(_maps.begin(), _maps.end(), start, [](const ProcMap &m, uintptr_t a)
+                                   { return m.startAddress < a; });
+        for (; it != _maps.end() && it->endAddress <= end; ++it)
+            retMaps.push_back(*it);
+
+        return retMaps;
+    }
+
+    template <typename Pred>
+    std::vector<ProcMap> ProcMapIndex::getMapsIf(const std::string &name, Pred pred) const
+    {
+        std::vector<ProcMap> retMaps;
+
+        if (_maps.empty() || name.empty())
+            return retMaps;
+
+        // match unique pathnames only then return maps in address order
+        std::vector<size_t> indices;
+        for (auto &it : _pathMaps)
+        {
+            if (pred(it.first))
+                indices.insert(indices.end(), it.second.begin(), it.second.end());
+        }
+
+        std::sort(indices.begin(), indices.end());
+
+        retMaps.reserve(indices.size());
+        for (size_t i : indices)
+            retMaps.push_back(_maps[i]);
+
+        return retMaps;
+    }
+
+    std::vector<ProcMap> ProcMapIndex::getMapsEqual(const std::string &name) const
+    {
+        std::vector<ProcMap> retMaps;
+
+        auto it = _pathMaps.find(name);
+        if (it == _pathMaps.end())
+            return retMaps;
+
+        retMaps.reserve(it->second.size());
+        for (size_t i : it->second)
+            retMaps.push_back(_maps[i]);
+
+        return retMaps;
+    }
+
+    std::vector<ProcMap> ProcMapIndex::getMapsContain(const std::string &name) const
+    {
+        return getMapsIf(name, [&name](const std::string &pathname)
+                         { return KittyUtils::String::Contains(pathname, name); });
+    }
+
+    std::vector<ProcMap> ProcMapIndex::getMapsEndWith(const std::string &name) const
+    {
+        return getMapsIf(name, [&name](const std::string &pathname)
+                         { return KittyUtils::String::EndsWith(pathname, name); });
+    }
+
+    ProcMapsDiff diffMaps(const std::vector<ProcMap> &oldMaps, const std::vector<ProcMap> &newMaps)
+    {
+        ProcMapsDiff diff;
+
+        size_t o = 0, n = 0;
+        while (o < oldMaps.size() && n < newMaps.size())
+        {
+            const ProcMap &a = oldMaps[o], &b = newMaps[n];
+            if (a.startAddress < b.startAddress)
+            {
+                diff.removed.push_back(a);
+                o++;
+            }
+            else if (b.startAddress < a.startAddress)
+            {
+                diff.added.push_back(b);
+                n++;
+            }
+            else
+            {
+                if (a != b)
+                {
+                    if (a.endAddress == b.endAddress && a.offset == b.offset &&
+                        a.inode == b.inode && a.dev == b.dev && a.pathname == b.pathname)
+                    {
+                        diff.changed.push_back(b);
+                    }
+                    else
+                    {
+                        diff.removed.push_back(a);
+                        diff.added.push_back(b);
+                    }
+                }
+                o++, n++;
+            }
+        }
+
+        diff.removed.insert(diff.removed.end(), oldMaps.begin() + o, oldMaps.end());
+        diff.added.insert(diff.added.end(), newMaps.begin() + n, newMaps.end());
+
+        return diff;
+    }
+
+    bool MapsWatcher::update(ProcMapsDiff *diff)
+    {
+        if (diff)
+            diff->clear();
+
+        if (_pid <= 0 || !readMapsFile(_pid, &_buf))
+            return false;
+
+        // exact compare with previous content, cheaper than parsing
+        if (_updates && _buf.size() == _prevBuf.size() && memcmp(_buf.data(), _prevBuf.data(), _buf.size()) == 0)
+            return false;
+
+        std::vector<ProcMap> maps = parseMaps(_pid, _buf.data(), _buf.size());
+        if (diff)
+            *diff = diffMaps(_maps, maps);
+
+        _buf.swap(_prevBuf);
+        _maps = std::move(maps);
+        _updates++;
+        return true;
+    }
+
 #ifdef __ANDROID__
     std::string getAppDirectory(const std::string &pkg)
     {
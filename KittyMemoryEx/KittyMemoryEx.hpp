@@ -2,6 +2,8 @@
 
 #include "KittyUtils.hpp"
 
+#include <unordered_map>
+
 namespace KittyMemoryEx
 {
   class ProcMap
@@ -112,6 +114,125 @@ namespace KittyMemoryEx
    */
   ProcMap getAddressMap(pid_t pid, uintptr_t address);
 
+  /*
+   * Index over a maps snapshot for repeated lookups
+   * address lookups are binary searches, pathname lookups go through a pathname table
+   * returned pointers are valid as long as the index is alive
+   */
+  class ProcMapIndex
+  {
+  private:
+    std::vector<ProcMap> _maps; // sorted by startAddress
+    std::unordered_map<std::string, std::vector<size_t>> _pathMaps;
+
+    template <typename Pred>
+    std::vector<ProcMap> getMapsIf(const std::string &name, Pred pred) const;
+
+  public:
+    ProcMapIndex() {}
+    explicit ProcMapIndex(std::vector<ProcMap> maps);
+    explicit ProcMapIndex(pid_t pid) : ProcMapIndex(getAllMaps(pid)) {}
+
+    inline const std::vector<ProcMap> &maps() const { return _maps; }
+    inline size_t size() const { return _maps.size(); }
+    inline bool empty() const { return _maps.empty(); }
+
+    /*
+     * Map containing address or nullptr
+     */
+    const ProcMap *find(uintptr_t address) const;
+
+    /*
+     * Map containing address for each address or nullptr
+     * one merge pass when addresses are sorted ascending, binary search otherwise
+     */
+    std::vector<const ProcMap *> findBatch(const std::vector<uintptr_t> &addresses) const;
+
+    /*
+     * Maps that lie entirely inside [start, end), in address order
+     */
+    std::vector<ProcMap> getMapsInRange(uintptr_t start, uintptr_t end) const;
+
+    /*
+     * Gets map info of an address
+     */
+    inline ProcMap getAddressMap(uintptr_t address) const
+    {
+        const ProcMap *map = find(address);
+        return map ? *map : ProcMap();
+    }
+
+    /*
+     * Gets info of all maps which pathname equals name
+     */
+    std::vector<ProcMap> getMapsEqual(const std::string &name) const;
+
+    /*
+     * Gets info of all maps which pathname contains name
+     */
+    std::vector<ProcMap> getMapsContain(const std::string &name) const;
+
+    /*
+     * Gets info of all maps which pathname ends with name
+     */
+    std::vector<ProcMap> getMapsEndWith(const std::string &name) const;
+  };
+
+  /*
+   * Difference between two maps snapshots
+   * changed holds maps with same range and backing but different protection (new state)
+   */
+  struct ProcMapsDiff
+  {
+    std::vector<ProcMap> added;
+    std::vector<ProcMap> removed;
+    std::vector<ProcMap> changed;
+
+    inline bool empty() const { return added.empty() && removed.empty() && changed.empty(); }
+    inline void clear() { added.clear(), removed.clear(), changed.clear(); }
+  };
+
+  /*
+   * Compares two maps snapshots sorted by address
+   */
+  ProcMapsDiff diffMaps(const std::vector<ProcMap> &oldMaps, const std::vector<ProcMap> &newMaps);
+
+  /*
+   * Keeps the last maps snapshot of a process for cheap polling
+   * maps file is only parsed again when its content changes
+   */
+  class MapsWatcher
+  {
+  private:
+    pid_t _pid;
+    size_t _updates;
+    std::vector<char> _buf, _prevBuf;
+    std::vector<ProcMap> _maps;
+
+  public:
+    MapsWatcher() : _pid(0), _updates(0) {}
+    explicit MapsWatcher(pid_t pid) : _pid(pid), _updates(0) {}
+
+    inline pid_t processID() const { return _pid; }
+
+    /*
+     * Last maps snapshot
+     */
+    inline const std::vector<ProcMap> &maps() const { return _maps; }
+
+    /*
+     * Number of times the snapshot changed
+     */
+    inline size_t updates() const { return _updates; }
+
+    /*
+     * Re-reads maps file and updates snapshot if it changed
+     * @param diff: optional, set to what changed since the last snapshot
+     * @return true if maps changed
+     */
+    bool update(ProcMapsDiff *diff = nullptr);
+  };
+
   #ifdef __ANDROID__
     std::string getAppDirectory(const std::string &pkg);
   #endif
@@ -17,6 +17,8 @@ bool KittyMemoryMgr::initialize(pid_t pid, EKittyMemOP eMemOp, bool initMemPatch
     if (_pMemOp.get())
         _pMemOp.reset();
 
+    _pMemCache = nullptr;
+
     _eMemOp = eMemOp;
     switch (eMemOp)
     {
@@ -26,6 +28,14 @@ bool KittyMemoryMgr::initialize(pid_t pid, EKittyMemOP eMemOp, bool initMemPatch
     case EK_MEM_OP_IO:
         _pMemOp = std::make_unique<KittyMemIO>();
         break;
+    case EK_MEM_OP_SYSCALL_CACHE:
+        _pMemOp = std::make_unique<KittyMemCache>(std::make_unique<KittyMemSys>());
+        _pMemCache = static_cast<KittyMemCache *>(_pMemOp.get());
+        break;
+    case EK_MEM_OP_IO_CACHE:
+        _pMemOp = std::make_unique<KittyMemCache>(std::make_unique<KittyMemIO>());
+        _pMemCache = static_cast<KittyMemCache *>(_pMemOp.get());
+        break;
     default:
         KITTY_LOGE("KittyMemoryMgr: Unknown memory operation.");
         return false;
@@ -42,7 +52,7 @@ bool KittyMemoryMgr::initialize(pid_t pid, EKittyMemOP eMemOp, bool initMemPatch
     // patching mem only avaialabe for IO operation
     if (initMemPatch)
     {
-        if (eMemOp == EK_MEM_OP_IO)
+        if (eMemOp == EK_MEM_OP_IO || eMemOp == EK_MEM_OP_IO_CACHE)
         {
             memPatch = MemoryPatchMgr(_pMemOp.get());
             memBackup = MemoryBackupMgr(_pMemOp.get());
@@ -67,6 +77,7 @@ bool KittyMemoryMgr::initialize(pid_t pid, EKittyMemOP eMemOp, bool initMemPatch
 
     memScanner = KittyScannerMgr(_pMemOp.get());
     elfScanner = ElfScannerMgr(_pMemOp.get());
+    _pModuleCache = std::make_unique<KittyModuleCache>(_pMemOp.get());
 
 #ifdef __ANDROID__
     // refs https://fadeevab.com/shared-library-injection-on-android-8/
@@ -76,6 +87,9 @@ bool KittyMemoryMgr::initialize(pid_t pid, EKittyMemOP eMemOp, bool initMemPatch
 #endif
     trace = KittyTraceMgr(_pMemOp.get(), defaultCaller);
 
+    // only sets the pid, pagemap is opened by the first dirty scanner, resident-only read or cache invalidation
+    pageMap.init(_pid);
+
     return true;
 }
 
@@ -87,6 +101,22 @@ size_t KittyMemoryMgr::readMem(uintptr_t address, void *buffer, size_t len) cons
     return _pMemOp->Read(address, buffer, len);
 }
 
+size_t KittyMemoryMgr::readMemBatch(mem_request_t *requests, size_t count) const
+{
+    if (!isMemValid() || !requests || !count)
+        return 0;
+
+    return _pMemOp->ReadBatch(requests, count);
+}
+
+size_t KittyMemoryMgr::readMemMapped(uintptr_t address, void *buffer, size_t len, std::vector<bool> *readablePages) const
+{
+    if (!isMemValid() || !buffer || !len)
+        return 0;
+
+    return _pMemOp->ReadMapped(address, buffer, len, readablePages);
+}
+
 size_t KittyMemoryMgr::writeMem(uintptr_t address, void *buffer, size_t len) const
 {
     if (!isMemValid() || !buffer || !len)
@@ -95,6 +125,105 @@ size_t KittyMemoryMgr::writeMem(uintptr_t address, void *buffer, size_t len) con
     return _pMemOp->Write(address, buffer, len);
 }
 
+size_t KittyMemoryMgr::writeMemBatch(mem_request_t *requests, size_t count) const
+{
+    if (!isMemValid() || !requests || !count)
+        return 0;
+
+    return _pMemOp->WriteBatch(requests, count);
+}
+
+std::vector<uintptr_t> KittyMemoryMgr::resolvePointerChains(const std::vector<pointer_chain_t> &chains) const
+{
+    std::vector<uintptr_t> results(chains.size(), 0);
+
+    if (!isMemValid() || chains.empty())
+        return results;
+
+    const KittyMemoryEx::ProcMapIndex maps(_pid);
+    auto is_readable = [&maps](uintptr_t address) -> bool
+    {
+        const ProcMap *map = maps.find(address);
+        return map && map->readable && map->contains(address + sizeof(uintptr_t) - 1);
+    };
+
+    std::vector<uintptr_t> current(chains.size(), 0);
+    std::vector<bool> alive(chains.size(), false);
+    for (size_t i = 0; i < chains.size(); i++)
+    {
+        current[i] = chains[i].base;
+        alive[i] = chains[i].base != 0;
+    }
+
+    std::vector<mem_request_t> requests;
+    std::vector<size_t> owners;
+    for (size_t level = 0;; level++)
+    {
+        requests.clear();
+        owners.clear();
+
+        for (size_t i = 0; i < chains.size(); i++)
+        {
+            if (!alive[i] || level + 1 >= chains[i].offsets.size())
+                continue;
+
+            uintptr_t hop = current[i] + chains[i].offsets[level];
+            if (!is_readable(hop))
+            {
+                alive[i] = false;
+                continue;
+            }
+
+            requests.emplace_back(hop, &current[i], sizeof(uintptr_t));
+            owners.push_back(i);
+        }
+
+        if (requests.empty())
+            break;
+
+        _pMemOp->ReadBatch(requests);
+
+        for (size_t r = 0; r < requests.size(); r++)
+        {
+            if (requests[r].result != sizeof(uintptr_t) || !current[owners[r]])
+                alive[owners[r]] = false;
+        }
+    }
+
+    for (size_t i = 0; i < chains.size(); i++)
+    {
+        if (alive[i])
+            results[i] = current[i] + (chains[i].offsets.empty() ? 0 : chains[i].offsets.back());
+    }
+
+    return results;
+}
+
+ValueScanner KittyMemoryMgr::createValueScanner(EKittyValueType type, size_t alignment) const
+{
+    if (!isMemValid())
+        return ValueScanner();
+
+    return ValueScanner(_pMemCache ? _pMemCache->backend() : _pMemOp.get(), type, alignment);
+}
+
+ValueScanner KittyMemoryMgr::createDirtyValueScanner(EKittyValueType type, size_t alignment)
+{
+    ValueScanner scanner = createValueScanner(type, alignment);
+    if (scanner.isValid() && pageMap.isValid())
+        scanner.setPageMap(&pageMap);
+
+    return scanner;
+}
+
+PointerScanner KittyMemoryMgr::createPointerScanner() const
+{
+    if (!isMemValid())
+        return PointerScanner();
+
+    return PointerScanner(_pMemCache ? _pMemCache->backend() : _pMemOp.get());
+}
+
 std::string KittyMemoryMgr::readMemStr(uintptr_t address, size_t maxLen) const
 {
     if (!isMemValid() || !address || !maxLen)
@@ -122,47 +251,10 @@ bool KittyMemoryMgr::isValidELF(uintptr_t elfBase) const
 
 ElfScanner KittyMemoryMgr::getMemElf(const std::string &elfName) const
 {
-    ElfScanner ret{};
-
     if (!isMemValid() || elfName.empty())
-        return ret;
-
-    // sometimes an ELF has two loads
-    // the one we should use is the one with more segments than other
-
-    std::vector<ElfScanner> elfs;
-
-    auto maps = KittyMemoryEx::getMapsContain(_pid, elfName);
-    for (auto &it : maps)
-    {
-        if (!isValidELF(it.startAddress))
-            continue;
-
-        auto elf = elfScanner.createWithMap(it);
-        if (elf.isValid())
-            elfs.push_back(elf);
-    }
-
-    if (elfs.empty())
-        return ret;
-
-    ret = elfs.front();
-
-    if (elfs.size() == 1)
-        return ret;
-
-    int nMostSegments = 0;
-    for (auto &it : elfs)
-    {
-        int numSegments = it.segments().size();
-        if (numSegments > nMostSegments)
-        {
-            ret = it;
-            nMostSegments = numSegments;
-        }
-    }
+        return {};
 
-    return ret;
+    return _pModuleCache->getElf(elfName);
 }
 
 ElfScanner KittyMemoryMgr::getMemElfInZip(const std::string& zip, const std::string& elfName) const
@@ -174,7 +266,8 @@ ElfScanner KittyMemoryMgr::getMemElfInZip(const std::string& zip, const std::str
     if (!isMemValid() || elfName.empty())
         return ret;
 
-    auto maps = KittyMemoryEx::getMapsEndWith(_pid, zip);
+    auto allMaps = std::make_shared<const KittyMemoryEx::ProcMapIndex>(_pid);
+    auto maps = allMaps->getMapsEndWith(zip);
     if (maps.empty())
         return ret;
 
@@ -197,7 +290,7 @@ ElfScanner KittyMemoryMgr::getMemElfInZip(const std::string& zip, const std::str
                 {
                     if (it.inode == map.inode && it.offset == data_offset)
                     {
-                        ret = elfScanner.createWithMap(it);
+                        ret = elfScanner.createWithMap(it, allMaps);
                         found = true;
                         break;
                     }
@@ -235,29 +328,86 @@ uintptr_t KittyMemoryMgr::findRemoteOfSymbol(const local_symbol_t &local_sym) co
     if (!isMemValid() || !local_sym.name || !local_sym.address)
         return 0;
 
-    ElfScanner r_lib{};
-    ProcMap l_lib{};
+    uintptr_t r_lib_base = 0, remote_address = 0;
 
-    l_lib = KittyMemoryEx::getAddressMap(getpid(), local_sym.address);
+    ProcMap l_lib = KittyMemoryEx::getAddressMap(getpid(), local_sym.address);
     if (l_lib.isValid())
-        r_lib = getMemElf(l_lib.pathname);
+        remote_address = _pModuleCache->findSymbol(l_lib.pathname, local_sym.name, &r_lib_base);
 
-    if (!r_lib.isValid())
+    if (!r_lib_base)
     {
         KITTY_LOGE("KittyInjector: Failed to find %s, remote lib not found.", local_sym.name);
         return 0;
     }
-    
-    uintptr_t remote_address = r_lib.findSymbol(local_sym.name);
-    
+
     // fallback
     if (!remote_address)
-        remote_address = local_sym.address - l_lib.startAddress + r_lib.base();
+        remote_address = local_sym.address - l_lib.startAddress + r_lib_base;
 
     return remote_address;
 }
 
-bool KittyMemoryMgr::dumpMemRange(uintptr_t start, uintptr_t end, const std::string &destination) const
+std::vector<uintptr_t> KittyMemoryMgr::findRemoteOfSymbols(const std::vector<local_symbol_t> &local_syms) const
+{
+    std::vector<uintptr_t> remote_addresses(local_syms.size(), 0);
+    if (!isMemValid() || local_syms.empty())
+        return remote_addresses;
+
+    std::vector<uintptr_t> local_addresses;
+    local_addresses.reserve(local_syms.size());
+    for (auto &it : local_syms)
+        local_addresses.push_back(it.address);
+
+    const KittyMemoryEx::ProcMapIndex l_maps(getpid());
+    const auto l_libs = l_maps.findBatch(local_addresses);
+
+    // symbol indices grouped by local lib
+    std::unordered_map<std::string, std::vector<size_t>> groups;
+    for (size_t i = 0; i < local_syms.size(); i++)
+    {
+        if (!local_syms[i].name || !local_syms[i].address)
+            continue;
+
+        if (!l_libs[i])
+        {
+            KITTY_LOGE("KittyInjector: Failed to find %s, local lib not found.", local_syms[i].name);
+            continue;
+        }
+
+        groups[l_libs[i]->pathname].push_back(i);
+    }
+
+    for (auto &group : groups)
+    {
+        std::vector<std::string_view> names;
+        names.reserve(group.second.size());
+        for (size_t i : group.second)
+            names.emplace_back(local_syms[i].name);
+
+        uintptr_t r_lib_base = 0;
+        auto addresses = _pModuleCache->findSymbols(group.first, names.data(), names.size(), &r_lib_base);
+        if (!r_lib_base)
+        {
+            for (size_t i : group.second)
+                KITTY_LOGE("KittyInjector: Failed to find %s, remote lib not found.", local_syms[i].name);
+            continue;
+        }
+
+        for (size_t j = 0; j < group.second.size(); j++)
+        {
+            const size_t i = group.second[j];
+            remote_addresses[i] = addresses[j];
+
+            // fallback
+            if (!remote_addresses[i])
+                remote_addresses[i] = local_syms[i].address - l_libs[i]->startAddress + r_lib_base;
+        }
+    }
+
+    return remote_addresses;
+}
+
+bool KittyMemoryMgr::dumpMemRange(uintptr_t start, uintptr_t end, const std::string &destination, bool residentOnly) const
 {
     if (!isMemValid())
         return false;
@@ -299,16 +449,38 @@ bool KittyMemoryMgr::dumpMemRange(uintptr_t start, uintptr_t end, const std::str
 
     KITTY_LOGI("dumpMemRange: Dumping: [ %p - %p | Size: %zu%s ] ...", (void *)start, (void *)end, displaySize, units[u]);
 
-    size_t read_sz = srcFile.Read(start, dmmap, dumpSize);
-    if (!read_sz)
+    size_t read_sz = 0, expected_sz = dumpSize;
+    PageResidency residency;
+    KittyMemoryEx::ProcMapIndex maps;
+    if (residentOnly)
+        maps = KittyMemoryEx::ProcMapIndex(_pid);
+
+    if (residentOnly && residency.query(pageMap, start, end, &maps))
+    {
+        // untouched anonymous pages stay zero in the anonymous buffer, file backed ones are always read
+        expected_sz = 0;
+        for (auto &range : residency.residentRanges())
+        {
+            expected_sz += range.second - range.first;
+            read_sz += srcFile.Read(range.first, (char *)dmmap + (range.first - start), range.second - range.first);
+        }
+
+        KITTY_LOGI("dumpMemRange: %zu of %zu bytes are resident.", expected_sz, dumpSize);
+    }
+    else
+    {
+        read_sz = srcFile.Read(start, dmmap, dumpSize);
+    }
+
+    if (!read_sz && expected_sz)
     {
         KITTY_LOGE("dumpMemRange: failed to read memory range (%p - %p).", (void *)start, (void *)end);
         munmap(dmmap, dumpSize);
         return false;
     }
 
-    if (read_sz != dumpSize)
-        KITTY_LOGW("dumpMemRange: dump size %zu but bytes read %zu. error=%s.", dumpSize, read_sz, srcFile.lastStrError().c_str());
+    if (read_sz != expected_sz)
+        KITTY_LOGW("dumpMemRange: dump size %zu but bytes read %zu. error=%s.", expected_sz, read_sz, srcFile.lastStrError().c_str());
 
     ssize_t write_sz = dstFile.Write(0, dmmap, dumpSize);
     if (write_sz <= 0)
@@ -327,7 +499,7 @@ bool KittyMemoryMgr::dumpMemRange(uintptr_t start, uintptr_t end, const std::str
     return true;
 }
 
-bool KittyMemoryMgr::dumpMemFile(const std::string &memFile, const std::string &destination) const
+bool KittyMemoryMgr::dumpMemFile(const std::string &memFile, const std::string &destination, bool residentOnly) const
 {
     if (!isMemValid() || memFile.empty() || destination.empty())
         return false;
@@ -351,14 +523,14 @@ bool KittyMemoryMgr::dumpMemFile(const std::string &memFile, const std::string &
         }
     }
 
-    return dumpMemRange(firstMap.startAddress, lastEnd, destination);
+    return dumpMemRange(firstMap.startAddress, lastEnd, destination, residentOnly);
 }
 
-bool KittyMemoryMgr::dumpMemELF(uintptr_t elfBase, const std::string &destination) const
+bool KittyMemoryMgr::dumpMemELF(uintptr_t elfBase, const std::string &destination, bool residentOnly) const
 {
     if (!isMemValid() || !elfBase)
         return false;
 
     ElfScanner elf = elfScanner.createWithBase(elfBase);
-    return elf.isValid() && dumpMemRange(elfBase, elf.end(), destination);
+    return elf.isValid() && dumpMemRange(elfBase, elf.end(), destination, residentOnly);
 }
\ No newline at end of file
@@ -4,9 +4,14 @@
 #include "KittyIOFile.hpp"
 #include "KittyMemoryEx.hpp"
 #include "KittyMemOp.hpp"
+#include "KittyMemCache.hpp"
+#include "KittyPageMap.hpp"
+#include "KittyModuleCache.hpp"
 #include "MemoryPatch.hpp"
 #include "MemoryBackup.hpp"
 #include "KittyScanner.hpp"
+#include "ValueScanner.hpp"
+#include "PointerScanner.hpp"
 #include "KittyTrace.hpp"
 #include "KittyArm64.hpp"
 
@@ -23,6 +28,19 @@ struct local_symbol_t
 
 #define KT_LOCAL_SYMBOL(x) local_symbol_t(#x, uintptr_t(x))
 
+/**
+ * Pointer chain [[[base + offsets[0]] + offsets[1]] + ...] + offsets[n-1]
+ * every offset except the last one is dereferenced
+ */
+struct pointer_chain_t
+{
+    uintptr_t base = 0;
+    std::vector<uintptr_t> offsets;
+
+    pointer_chain_t() : base(0) {}
+    pointer_chain_t(uintptr_t b, const std::vector<uintptr_t> &o) : base(b), offsets(o) {}
+};
+
 class KittyMemoryMgr
 {
 private:
@@ -32,6 +50,8 @@ private:
     EKittyMemOP _eMemOp;
     std::unique_ptr<IKittyMemOp> _pMemOp;
     std::unique_ptr<IKittyMemOp> _pMemOpPatch;
+    KittyMemCache *_pMemCache;
+    std::unique_ptr<KittyModuleCache> _pModuleCache;
 
 public:
     MemoryPatchMgr memPatch;
@@ -39,13 +59,14 @@ public:
     KittyScannerMgr memScanner;
     ElfScannerMgr elfScanner;
     KittyTraceMgr trace;
+    KittyPageMap pageMap;
 
-    KittyMemoryMgr() : _init(false), _pid(0), _eMemOp(EK_MEM_OP_NONE) {}
+    KittyMemoryMgr() : _init(false), _pid(0), _eMemOp(EK_MEM_OP_NONE), _pMemCache(nullptr) {}
 
     /**
      * Initialize memory manager
      * @param pid remote process ID
-     * @param eMemOp: Memory read & write operation type [ EK_MEM_OP_SYSCALL / EK_MEM_OP_IO ]
+     * @param eMemOp: Memory read & write operation type [ EK_MEM_OP_SYSCALL / EK_MEM_OP_IO / EK_MEM_OP_SYSCALL_CACHE / EK_MEM_OP_IO_CACHE ]
      * @param initMemPatch: initialize MmeoryPatch & MemoryBackup instances, pass true if you want to use memPatch & memBackup
      */
     bool initialize(pid_t pid, EKittyMemOP eMemOp, bool initMemPatch);
@@ -56,16 +77,79 @@ public:
 
     inline bool isMemValid() const { return _init && _pid && _pMemOp.get(); }
 
+    /**
+     * Read cache, only available with EK_MEM_OP_SYSCALL_CACHE / EK_MEM_OP_IO_CACHE
+     * with EK_MEM_OP_SYSCALL_CACHE memPatch writes bypass the cache, invalidate after patching
+     */
+    inline KittyMemCache *memCache() const { return _pMemCache; }
+
+    /**
+     * Parsed ELF modules reused by getMemElf and findRemoteOfSymbol(s)
+     */
+    inline KittyModuleCache *moduleCache() const { return _pModuleCache.get(); }
+
     /**
      * Read remote memory
      */
     size_t readMem(uintptr_t address, void *buffer, size_t len) const;
 
+    /**
+     * Read multiple remote ranges with as few syscalls as possible
+     * result of each request is set to its bytes read
+     */
+    size_t readMemBatch(mem_request_t *requests, size_t count) const;
+    inline size_t readMemBatch(std::vector<mem_request_t> &requests) const
+    {
+        return readMemBatch(requests.data(), requests.size());
+    }
+
+    /**
+     * Read remote memory skipping whole unreadable regions using a maps snapshot
+     * unreadable parts are zero filled, readablePages is set to one bit per page
+     */
+    size_t readMemMapped(uintptr_t address, void *buffer, size_t len, std::vector<bool> *readablePages = nullptr) const;
+
     /**
      * Write remote memory
      */
     size_t writeMem(uintptr_t address, void *buffer, size_t len) const;
 
+    /**
+     * Write multiple remote ranges with as few syscalls as possible
+     * result of each request is set to its bytes written
+     */
+    size_t writeMemBatch(mem_request_t *requests, size_t count) const;
+    inline size_t writeMemBatch(std::vector<mem_request_t> &requests) const
+    {
+        return writeMemBatch(requests.data(), requests.size());
+    }
+
+    /**
+     * Resolve pointer chains, all chains advance one level at a time with a single batched read per level
+     * null or unmapped hops are detected using a maps snapshot
+     * @return final address of each chain, 0 if chain is broken
+     */
+    std::vector<uintptr_t> resolvePointerChains(const std::vector<pointer_chain_t> &chains) const;
+
+    /**
+     * Create a typed value scanner for this process
+     * reads bypass the read cache since values are expected to change
+     * @param alignment: value alignment, 0 for value size
+     */
+    ValueScanner createValueScanner(EKittyValueType type, size_t alignment = 0) const;
+
+    /**
+     * Create a typed value scanner whose next scans only re-read pages written since the previous scan
+     * falls back to full re-reads when soft-dirty bits are unavailable, see KittyPageMap
+     */
+    ValueScanner createDirtyValueScanner(EKittyValueType type, size_t alignment = 0);
+
+    /**
+     * Create a reverse pointer scanner for this process, call snapshot() before scanning
+     * reads bypass the read cache
+     */
+    PointerScanner createPointerScanner() const;
+
     /**
      * Read string from remote memory
      */
@@ -104,18 +188,26 @@ public:
     */
     uintptr_t findRemoteOfSymbol(const local_symbol_t &local_sym) const;
 
+    /**
+     * Batched findRemoteOfSymbol, local maps are read once and each remote lib is parsed once
+     * @return remote addresses in input order, 0 for symbols that couldn't be resolved
+     */
+    std::vector<uintptr_t> findRemoteOfSymbols(const std::vector<local_symbol_t> &local_syms) const;
+
     /**
      * Dump remote memory range
+     * @param residentOnly: skip never touched pages of anonymous maps and dump them as zeros,
+     * pages of file backed maps (code, mapped data) are always read
      */
-    bool dumpMemRange(uintptr_t start, uintptr_t end, const std::string &path) const;
+    bool dumpMemRange(uintptr_t start, uintptr_t end, const std::string &path, bool residentOnly = false) const;
 
     /**
      * Dump remote memory maped file
      */
-    bool dumpMemFile(const std::string &memFile, const std::string &destination) const;
+    bool dumpMemFile(const std::string &memFile, const std::string &destination, bool residentOnly = false) const;
 
     /**
      * Dump remote memory loaded ELF
      */
-    bool dumpMemELF(uintptr_t elfBase, const std::string &destination) const;
+    bool dumpMemELF(uintptr_t elfBase, const std::string &destination, bool residentOnly = false) const;
 };
\ No newline at end of file
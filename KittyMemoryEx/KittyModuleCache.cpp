@@ -0,0 +1,163 @@
+#include "KittyModuleCache.hpp"
+
+void KittyModuleCache::refresh()
+{
+    KittyMemoryEx::ProcMapsDiff diff;
+    if (!_watcher.update(&diff))
+        return;
+
+    _maps = std::make_shared<const KittyMemoryEx::ProcMapIndex>(_watcher.maps());
+
+    if (_modules.empty())
+        return;
+
+    // drop modules that had any of their maps added, removed or changed
+    auto touches = [&diff](uintptr_t start, uintptr_t end)
+    {
+        for (auto *maps : {&diff.added, &diff.removed, &diff.changed})
+        {
+            for (auto &it : *maps)
+            {
+                if (it.startAddress < end && it.endAddress > start)
+                    return true;
+            }
+        }
+        return false;
+    };
+
+    for (auto it = _modules.begin(); it != _modules.end();)
+    {
+        if (touches(it->first.base, it->second->end))
+            it = _modules.erase(it);
+        else
+            ++it;
+    }
+}
+
+std::shared_ptr<KittyModuleCache::module_t> KittyModuleCache::findModule(const std::string &elfName)
+{
+    if (!_pMem || elfName.empty())
+        return nullptr;
+
+    refresh();
+    if (!_maps)
+        return nullptr;
+
+    // sometimes an ELF has two loads
+    // the one we should use is the one with more segments than other
+
+    std::vector<std::shared_ptr<module_t>> elfs;
+
+    for (auto &it : _maps->getMapsContain(elfName))
+    {
+        if (!it.readable)
+            continue;
+
+        auto &module = _modules[{it.inode, uintptr_t(it.startAddress)}];
+        if (!module)
+        {
+            module = std::make_shared<module_t>();
+            module->elf = ElfScanner(_pMem, it.startAddress, _maps);
+            module->end = std::max(module->elf.end(), uintptr_t(it.endAddress));
+            // counted before other threads can reach the module so picking one below needs no module lock
+            if (module->elf.isValid())
+                module->segments = module->elf.segments().size();
+            _misses++;
+        }
+        else
+        {
+            _hits++;
+        }
+
+        if (module->elf.isValid())
+            elfs.push_back(module);
+    }
+
+    if (elfs.empty())
+        return nullptr;
+
+    if (elfs.size() == 1)
+        return elfs.front();
+
+    std::shared_ptr<module_t> ret = elfs.front();
+    size_t nMostSegments = 0;
+    for (auto &it : elfs)
+    {
+        if (it->segments > nMostSegments)
+        {
+            ret = it;
+            nMostSegments = it->segments;
+        }
+    }
+
+    return ret;
+}
+
+ElfScanner KittyModuleCache::getElf(const std::string &elfName)
+{
+    std::shared_ptr<module_t> module;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        module = findModule(elfName);
+    }
+
+    if (!module)
+        return {};
+
+    std::lock_guard<std::mutex> lock(module->mutex);
+    return module->elf;
+}
+
+std::vector<uintptr_t> KittyModuleCache::findSymbols(const std::string &elfName, const std::string_view *symbolNames,
+                                                     size_t count, uintptr_t *elfBase)
+{
+    if (elfBase)
+        *elfBase = 0;
+
+    std::shared_ptr<module_t> module;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        module = findModule(elfName);
+    }
+
+    if (!module)
+        return std::vector<uintptr_t>(count, 0);
+
+    std::lock_guard<std::mutex> lock(module->mutex);
+    if (elfBase)
+        *elfBase = module->elf.base();
+
+    return module->elf.findSymbols(symbolNames, count);
+}
+
+uintptr_t KittyModuleCache::findSymbol(const std::string &elfName, const std::string &symbolName, uintptr_t *elfBase)
+{
+    std::string_view name(symbolName);
+    return findSymbols(elfName, &name, 1, elfBase).front();
+}
+
+size_t KittyModuleCache::size()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _modules.size();
+}
+
+size_t KittyModuleCache::hits()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+size_t KittyModuleCache::misses()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+void KittyModuleCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _modules.clear();
+    _maps.reset();
+    _watcher = KittyMemoryEx::MapsWatcher(_watcher.processID());
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "KittyUtils.hpp"
+#include "KittyMemoryEx.hpp"
+#include "KittyMemOp.hpp"
+#include "KittyScanner.hpp"
+
+#include <map>
+#include <mutex>
+#include <string_view>
+
+/**
+ * Per process cache of parsed ELF modules, their hash tables and symbol indexes
+ * modules are keyed by (inode, base) and dropped once a maps change touches their range,
+ * every lookup re-reads the maps file but it is only parsed again when its content changed
+ * thread safe, the module table lock is held while maps are refreshed and new modules are parsed,
+ * symbol lookups then only lock their own module
+ */
+class KittyModuleCache
+{
+private:
+    struct module_key_t
+    {
+        unsigned long inode;
+        uintptr_t base;
+
+        inline bool operator<(const module_key_t &other) const
+        {
+            return inode != other.inode ? inode < other.inode : base < other.base;
+        }
+    };
+
+    struct module_t
+    {
+        ElfScanner elf;
+        uintptr_t end = 0;      // covers the map of invalid scanners too
+        size_t segments = 0;    // set before the module is published, read without mutex
+        std::mutex mutex;       // guards elf, its lazy state is filled on use
+    };
+
+    IKittyMemOp *_pMem;
+
+    std::mutex _mutex;
+    KittyMemoryEx::MapsWatcher _watcher;
+    std::shared_ptr<const KittyMemoryEx::ProcMapIndex> _maps;
+    std::map<module_key_t, std::shared_ptr<module_t>> _modules; // non ELF candidates are kept too so they are read once
+
+    size_t _hits, _misses;
+
+    // re-reads maps and drops modules touched by changes, must hold _mutex
+    void refresh();
+    // module getMemElf would pick for elfName, must hold _mutex, never locks a module mutex
+    std::shared_ptr<module_t> findModule(const std::string &elfName);
+
+public:
+    KittyModuleCache() : _pMem(nullptr), _hits(0), _misses(0) {}
+    explicit KittyModuleCache(IKittyMemOp *pMem)
+        : _pMem(pMem), _watcher(pMem ? pMem->processID() : 0), _hits(0), _misses(0) {}
+
+    KittyModuleCache(const KittyModuleCache &) = delete;
+    KittyModuleCache &operator=(const KittyModuleCache &) = delete;
+
+    inline bool isValid() const { return _pMem != nullptr; }
+
+    /**
+     * Loaded ELF whose pathname contains elfName, same selection as KittyMemoryMgr::getMemElf
+     * copies share the symbol index of the cached module once it was loaded
+     */
+    ElfScanner getElf(const std::string &elfName);
+
+    /**
+     * Absolute address of each symbol in ELF elfName, 0 if not found
+     * hash tables and symbol index stay loaded for later lookups
+     *
+     * @param elfBase: optional, set to the module base or 0 if the module wasn't found
+     */
+    std::vector<uintptr_t> findSymbols(const std::string &elfName, const std::string_view *symbolNames, size_t count,
+                                       uintptr_t *elfBase = nullptr);
+
+    uintptr_t findSymbol(const std::string &elfName, const std::string &symbolName, uintptr_t *elfBase = nullptr);
+
+    /**
+     * Number of cached maps, ELF or not
+     */
+    size_t size();
+
+    /**
+     * Module lookups served from cache and parsed from remote memory
+     */
+    size_t hits();
+    size_t misses();
+
+    /**
+     * Drop all modules and the maps snapshot
+     */
+    void clear();
+};
@@ -0,0 +1,274 @@
+#include "KittyPageMap.hpp"
+#include "KittyMemoryEx.hpp"
+
+// pages closer than this share one pagemap read
+#define KT_PAGEMAP_MAX_GAP 64
+
+bool KittyPageMap::init(pid_t pid)
+{
+    std::lock_guard<std::mutex> lock(_openMutex);
+
+    _pid = 0;
+    _opened = false;
+    _softDirty = false;
+    _generation = 0;
+    _pagemap.reset();
+
+    if (pid < 1)
+    {
+        KITTY_LOGE("KittyPageMap: Invalid PID.");
+        return false;
+    }
+
+    _pid = pid;
+    return true;
+}
+
+bool KittyPageMap::open() const
+{
+    std::lock_guard<std::mutex> lock(_openMutex);
+    if (_opened)
+        return _pagemap.get() != nullptr;
+
+    _opened = true;
+
+    char path[256] = {0};
+    snprintf(path, sizeof(path), "/proc/%d/pagemap", _pid);
+    auto pagemap = std::make_unique<KittyIOFile>(path, O_RDONLY);
+    if (!pagemap->Open())
+    {
+        // not readable without privileges on most devices, users fall back to full reads
+        KITTY_LOGD("KittyPageMap: Couldn't open %s, error=%s", path, pagemap->lastStrError().c_str());
+        return false;
+    }
+
+    _softDirty = detectSoftDirty(pagemap.get());
+    _pagemap = std::move(pagemap);
+    return true;
+}
+
+bool KittyPageMap::detectSoftDirty(KittyIOFile *pagemap) const
+{
+    // newly touched pages are soft-dirty until the first clear, the stack always has some
+    for (auto &it : KittyMemoryEx::getAllMaps(_pid))
+    {
+        if (it.pathname != "[stack]")
+            continue;
+
+        std::vector<uint64_t> entries(it.length / _pageSize);
+        ssize_t bytes = pagemap->Read((it.startAddress / _pageSize) * sizeof(uint64_t), entries.data(),
+                                      entries.size() * sizeof(uint64_t));
+        size_t n = bytes > 0 ? size_t(bytes) / sizeof(uint64_t) : 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (isPresent(entries[i]) && isSoftDirty(entries[i]))
+                return true;
+        }
+        break;
+    }
+
+    KITTY_LOGD("KittyPageMap: soft-dirty bits are not available for pid %d.", _pid);
+    return false;
+}
+
+size_t KittyPageMap::readEntries(uintptr_t start, uintptr_t end, uint64_t *entries) const
+{
+    if (!isValid() || !entries || end <= start)
+        return 0;
+
+    const size_t count = (KT_PAGE_END(end) - KT_PAGE_START(start)) / _pageSize;
+    ssize_t n = _pagemap->Read((KT_PAGE_START(start) / _pageSize) * sizeof(uint64_t), entries, count * sizeof(uint64_t));
+    return n > 0 ? size_t(n) / sizeof(uint64_t) : 0;
+}
+
+size_t KittyPageMap::readEntries(const uintptr_t *pages, size_t count, uint64_t *entries) const
+{
+    if (!isValid() || !pages || !entries || !count)
+        return 0;
+
+    memset(entries, 0, count * sizeof(uint64_t));
+
+    size_t total = 0;
+    std::vector<uint64_t> span;
+    for (size_t first = 0; first < count;)
+    {
+        size_t last = first + 1;
+        while (last < count && pages[last] >= pages[last - 1] &&
+               (pages[last] - pages[last - 1]) / _pageSize <= KT_PAGEMAP_MAX_GAP)
+            last++;
+
+        span.resize((pages[last - 1] - pages[first]) / _pageSize + 1);
+        size_t n = readEntries(pages[first], pages[last - 1] + _pageSize, span.data());
+        for (size_t i = first; i < last; i++)
+        {
+            size_t e = (pages[i] - pages[first]) / _pageSize;
+            if (e < n)
+            {
+                entries[i] = span[e];
+                total++;
+            }
+        }
+
+        first = last;
+    }
+
+    return total;
+}
+
+uint32_t KittyPageMap::clearSoftDirty()
+{
+    if (!isValid() || !_softDirty)
+        return 0;
+
+    char path[256] = {0};
+    snprintf(path, sizeof(path), "/proc/%d/clear_refs", _pid);
+    KittyIOFile clear_refs(path, O_WRONLY);
+    if (!clear_refs.Open() || clear_refs.Write(0, "4", 1) != 1)
+    {
+        KITTY_LOGE("Couldn't clear soft-dirty bits %s, error=%s", path, clear_refs.lastStrError().c_str());
+        return 0;
+    }
+
+    uint32_t generation = ++_generation;
+    // 0 means never cleared
+    if (!generation)
+        generation = ++_generation;
+
+    return generation;
+}
+
+std::vector<std::pair<uintptr_t, uintptr_t>> KittyPageMap::softDirtyRanges(uintptr_t start, uintptr_t end) const
+{
+    std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+    if (!isValid() || end <= start)
+        return ranges;
+
+    start = KT_PAGE_START(start);
+    end = KT_PAGE_END(end);
+
+    // treat everything as dirty when the kernel can't tell
+    if (!_softDirty)
+    {
+        ranges.emplace_back(start, end);
+        return ranges;
+    }
+
+    const size_t chunk_pages = 0x10000;
+    std::vector<uint64_t> entries(chunk_pages);
+    for (uintptr_t address = start; address < end; address += chunk_pages * _pageSize)
+    {
+        const uintptr_t chunk_end = std::min(end, address + chunk_pages * _pageSize);
+        size_t n = readEntries(address, chunk_end, entries.data());
+        const size_t npages = (chunk_end - address) / _pageSize;
+        for (size_t i = 0; i < npages; i++)
+        {
+            if (i < n && isClean(entries[i]))
+                continue;
+
+            const uintptr_t page = address + i * _pageSize;
+            if (!ranges.empty() && ranges.back().second == page)
+                ranges.back().second += _pageSize;
+            else
+                ranges.emplace_back(page, page + _pageSize);
+        }
+    }
+
+    return ranges;
+}
+
+bool PageResidency::query(const KittyPageMap &pageMap, uintptr_t start, uintptr_t end,
+                          const KittyMemoryEx::ProcMapIndex *maps)
+{
+    _start = start;
+    _end = std::max(start, end);
+    _known = false;
+    _entries.clear();
+    _fileBacked.clear();
+
+    if (!pageMap.isValid() || end <= start)
+        return false;
+
+    _entries.resize((KT_PAGE_END(end) - KT_PAGE_START(start)) / _pageSize);
+    _known = pageMap.readEntries(start, end, _entries.data()) == _entries.size();
+    if (!_known)
+    {
+        _entries.clear();
+        return false;
+    }
+
+    if (maps)
+    {
+        const uintptr_t first_page = KT_PAGE_START(start);
+        _fileBacked.resize(_entries.size(), false);
+
+        auto &all = maps->maps();
+        auto it = std::upper_bound(all.begin(), all.end(), start, [](uintptr_t a, const KittyMemoryEx::ProcMap &m)
+                                   { return a < m.endAddress; });
+        for (; it != all.end() && it->startAddress < end; ++it)
+        {
+            // anonymous private maps have no backing to read from
+            if (!it->inode)
+                continue;
+
+            const uintptr_t from = std::max(first_page, uintptr_t(it->startAddress));
+            const uintptr_t to = std::min(uintptr_t(KT_PAGE_END(end)), uintptr_t(it->endAddress));
+            for (uintptr_t page = from; page < to; page += _pageSize)
+                _fileBacked[(page - first_page) / _pageSize] = true;
+        }
+    }
+
+    return true;
+}
+
+bool PageResidency::residentAt(size_t page) const
+{
+    return (_entries[page] & (KT_PAGEMAP_PRESENT | KT_PAGEMAP_SWAPPED)) || (!_fileBacked.empty() && _fileBacked[page]);
+}
+
+uint64_t PageResidency::entry(uintptr_t address) const
+{
+    if (address < _start || address >= _end || _entries.empty())
+        return 0;
+
+    return _entries[(KT_PAGE_START(address) - KT_PAGE_START(_start)) / _pageSize];
+}
+
+size_t PageResidency::residentPages() const
+{
+    if (!_known)
+        return (KT_PAGE_END(_end) - KT_PAGE_START(_start)) / _pageSize;
+
+    size_t count = 0;
+    for (size_t i = 0; i < _entries.size(); i++)
+        count += residentAt(i);
+    return count;
+}
+
+std::vector<std::pair<uintptr_t, uintptr_t>> PageResidency::residentRanges() const
+{
+    std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+    if (_end <= _start)
+        return ranges;
+
+    if (!_known)
+    {
+        ranges.emplace_back(_start, _end);
+        return ranges;
+    }
+
+    const uintptr_t first_page = KT_PAGE_START(_start);
+    for (size_t i = 0; i < _entries.size(); i++)
+    {
+        if (!residentAt(i))
+            continue;
+
+        const uintptr_t page_start = std::max(_start, first_page + i * _pageSize);
+        const uintptr_t page_end = std::min(_end, first_page + (i + 1) * _pageSize);
+        if (!ranges.empty() && ranges.back().second == page_start)
+            ranges.back().second = page_end;
+        else
+            ranges.emplace_back(page_start, page_end);
+    }
+
+    return ranges;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "KittyUtils.hpp"
+#include "KittyIOFile.hpp"
+#include "KittyMemoryEx.hpp"
+
+#include <atomic>
+#include <mutex>
+
+// /proc/[pid]/pagemap entry bits
+#define KT_PAGEMAP_PRESENT (1ULL << 63)
+#define KT_PAGEMAP_SWAPPED (1ULL << 62)
+#define KT_PAGEMAP_FILE_SHARED (1ULL << 61)
+#define KT_PAGEMAP_EXCLUSIVE (1ULL << 56)
+#define KT_PAGEMAP_SOFT_DIRTY (1ULL << 55)
+
+/**
+ * Remote process page table view through /proc/[pid]/pagemap
+ * and soft-dirty tracking through /proc/[pid]/clear_refs
+ *
+ * soft-dirty state is process wide, every clearSoftDirty() starts a new generation,
+ * users remember the generation they cleared and treat all pages as dirty when it moved on
+ * writes racing with a clear can be missed, stop the process for exact results
+ * pagemap is opened and soft-dirty support detected on first use, not on init
+ */
+class KittyPageMap
+{
+private:
+    pid_t _pid;
+    size_t _pageSize;
+    mutable std::mutex _openMutex;
+    mutable bool _opened;
+    mutable std::unique_ptr<KittyIOFile> _pagemap;
+    mutable bool _softDirty;
+    std::atomic<uint32_t> _generation;
+
+    // opens pagemap once per init, later calls return the first result
+    bool open() const;
+    bool detectSoftDirty(KittyIOFile *pagemap) const;
+
+public:
+    KittyPageMap() : _pid(0), _pageSize(KT_PAGE_SIZE), _opened(false), _softDirty(false), _generation(0) {}
+
+    /**
+     * Set target process, pagemap isn't opened until first use
+     */
+    bool init(pid_t pid);
+
+    inline pid_t processID() const { return _pid; }
+
+    /**
+     * Pagemap of the process is readable, opens it on first call
+     */
+    inline bool isValid() const { return _pid > 0 && open(); }
+
+    /**
+     * Read entries of pages in [start, end)
+     * @return number of entries read
+     */
+    size_t readEntries(uintptr_t start, uintptr_t end, uint64_t *entries) const;
+
+    /**
+     * Read entries of sorted pages, nearby pages share a single read
+     * @return number of entries read, unread entries are zero
+     */
+    size_t readEntries(const uintptr_t *pages, size_t count, uint64_t *entries) const;
+
+    static inline bool isPresent(uint64_t entry) { return (entry & KT_PAGEMAP_PRESENT) != 0; }
+    static inline bool isSwapped(uint64_t entry) { return (entry & KT_PAGEMAP_SWAPPED) != 0; }
+    static inline bool isSoftDirty(uint64_t entry) { return (entry & KT_PAGEMAP_SOFT_DIRTY) != 0; }
+
+    /**
+     * Page content is known to be unchanged since the last clear
+     * pages that are neither present nor swapped were dropped or unmapped and count as changed
+     */
+    static inline bool isClean(uint64_t entry)
+    {
+        return (entry & (KT_PAGEMAP_PRESENT | KT_PAGEMAP_SWAPPED)) && !(entry & KT_PAGEMAP_SOFT_DIRTY);
+    }
+
+    /**
+     * Kernel tracks soft-dirty bits (CONFIG_MEM_SOFT_DIRTY), detected on first use
+     */
+    inline bool isSoftDirtySupported() const { return isValid() && _softDirty; }
+
+    /**
+     * Clear soft-dirty bits of all process pages
+     * @return new generation, 0 on failure or when soft-dirty is not supported
+     */
+    uint32_t clearSoftDirty();
+
+    /**
+     * Current generation, 0 if never cleared
+     */
+    inline uint32_t generation() const { return _generation.load(); }
+
+    /**
+     * Ranges in [start, end) written since the last clear, adjacent dirty pages merged
+     */
+    std::vector<std::pair<uintptr_t, uintptr_t>> softDirtyRanges(uintptr_t start, uintptr_t end) const;
+};
+
+/**
+ * Residency of the pages of a range, queried once through KittyPageMap
+ * present and swapped bits describe this process page table only, an anonymous page with neither
+ * was never touched (or dropped) and reads as zeros, but a file backed page with neither may just
+ * not be faulted into this mapping yet while its data is in page cache or on disk,
+ * so with maps given, pages of file backed maps always count as resident
+ */
+class PageResidency
+{
+private:
+    uintptr_t _start, _end;
+    size_t _pageSize;
+    std::vector<uint64_t> _entries;
+    std::vector<bool> _fileBacked;
+    bool _known;
+
+    bool residentAt(size_t page) const;
+
+public:
+    PageResidency() : _start(0), _end(0), _pageSize(KT_PAGE_SIZE), _known(false) {}
+
+    /**
+     * Query pages of [start, end)
+     * @param maps: optional maps snapshot, pages of file backed maps count as resident,
+     * without it only present or swapped pages do and unfaulted code or data of mapped files is missed
+     * @return false if pagemap couldn't be read, every page then counts as resident
+     */
+    bool query(const KittyPageMap &pageMap, uintptr_t start, uintptr_t end,
+               const KittyMemoryEx::ProcMapIndex *maps = nullptr);
+
+    inline uintptr_t start() const { return _start; }
+    inline uintptr_t end() const { return _end; }
+    inline bool isKnown() const { return _known; }
+
+    /**
+     * Pagemap entry of the page holding address, 0 when outside range
+     */
+    uint64_t entry(uintptr_t address) const;
+
+    inline bool isPresent(uintptr_t address) const { return !_known || KittyPageMap::isPresent(entry(address)); }
+    inline bool isSwapped(uintptr_t address) const { return _known && KittyPageMap::isSwapped(entry(address)); }
+    inline bool isResident(uintptr_t address) const
+    {
+        return !_known || (address >= _start && address < _end &&
+                           residentAt((KT_PAGE_START(address) - KT_PAGE_START(_start)) / _pageSize));
+    }
+
+    /**
+     * Number of resident pages
+     */
+    size_t residentPages() const;
+
+    /**
+     * Resident parts of the range, adjacent pages merged and clipped to [start, end)
+     */
+    std::vector<std::pair<uintptr_t, uintptr_t>> residentRanges() const;
+};
@@ -1,304 +1,1023 @@
 #include "KittyScanner.hpp"
 #include "KittyMemoryEx.hpp"
+#include "KittyIOFile.hpp"
+
+#include <thread>
+#include <atomic>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 // refs
 // https://github.com/learn-more/findpattern-bench
+// http://0x80.pl/articles/simd-strfind.html
+
+/* ======================= KittyPattern ======================= */
+
+KittyPattern::KittyPattern(const char *bytes, const std::string &mask) : _solid(0), _anchor1(0), _anchor2(0)
+{
+    if (!bytes || mask.empty())
+        return;
+
+    _bytes.assign(reinterpret_cast<const uint8_t *>(bytes), reinterpret_cast<const uint8_t *>(bytes) + mask.length());
+    _mask.resize(mask.length());
+    for (size_t i = 0; i < mask.length(); i++)
+        _mask[i] = mask[i] == 'x' ? 0xFF : 0x00;
+
+    compile();
+}
+
+KittyPattern::KittyPattern(const void *data, size_t size) : _solid(0), _anchor1(0), _anchor2(0)
+{
+    if (!data || !size)
+        return;
+
+    _bytes.assign(reinterpret_cast<const uint8_t *>(data), reinterpret_cast<const uint8_t *>(data) + size);
+    _mask.assign(size, 0xFF);
+
+    compile();
+}
+
+void KittyPattern::compile()
+{
+    for (size_t i = 0; i < _bytes.size(); i++)
+    {
+        if (!_mask[i])
+            _bytes[i] = 0;
+    }
+
+    _solid = selectAnchors(_bytes.data(), _mask.data(), _bytes.size(), &_anchor1, &_anchor2);
+    buildSkipTable();
+}
+
+void KittyPattern::buildSkipTable()
+{
+    _skip.clear();
+    if (!isExact() || _bytes.size() < KT_SCAN_HORSPOOL_MIN)
+        return;
+
+    // smaller shifts are only slower, cap them to fit a byte
+    const size_t n = _bytes.size();
+    _skip.assign(256, uint8_t(std::min(n, size_t(255))));
+    for (size_t i = 0; i + 1 < n; i++)
+        _skip[_bytes[i]] = uint8_t(std::min(n - 1 - i, size_t(255)));
+}
+
+KittyPattern KittyPattern::fromIda(const std::string &pattern)
+{
+    KittyPattern out;
+    if (pattern.empty())
+        return out;
+
+    // every byte takes at least one char
+    out._bytes.resize(pattern.length());
+    out._mask.resize(pattern.length());
+    size_t n = parseIda(pattern.data(), pattern.length(), out._bytes.data(), out._mask.data(), pattern.length());
+    out._bytes.resize(n);
+    out._mask.resize(n);
+
+    out.compile();
+    return out;
+}
+
+KittyPattern KittyPattern::fromHex(std::string hex, const std::string &mask)
+{
+    if (mask.empty() || !KittyUtils::String::ValidateHex(hex) || (hex.length() / 2) != mask.length())
+        return KittyPattern();
+
+    std::vector<char> bytes(mask.length());
+    KittyUtils::dataFromHex(hex, &bytes[0]);
+    return KittyPattern(bytes.data(), mask);
+}
+
+std::string KittyPattern::maskString() const
+{
+    std::string mask(_mask.size(), '?');
+    for (size_t i = 0; i < _mask.size(); i++)
+    {
+        if (_mask[i])
+            mask[i] = 'x';
+    }
+    return mask;
+}
+
+/* ======================= KittyScannerMgr ======================= */
+
+typedef const uint8_t *(*find_fn_t)(const uint8_t *begin, const uint8_t *end, const KittyPattern &pattern);
 
-static bool compare(const char *data, const char *pattern, const char *mask)
+static inline bool verifyScalar(const uint8_t *data, const KittyPattern &p, size_t from = 0)
 {
-    for (; *mask; ++mask, ++data, ++pattern)
+    for (size_t i = from; i < p.size(); i++)
     {
-        if (*mask == 'x' && *data != *pattern)
+        if ((data[i] ^ p.bytes()[i]) & p.mask()[i])
             return false;
     }
-    return !*mask;
+    return true;
 }
 
-static uintptr_t findInRange(const uintptr_t start, const uintptr_t end,
-                             const char *pattern, const std::string &mask)
+static const uint8_t *find_scalar(const uint8_t *begin, const uint8_t *end, const KittyPattern &p)
 {
-    const size_t scan_size = mask.length();
+    if (size_t(end - begin) < p.size())
+        return nullptr;
 
-    if (scan_size < 1 || ((start + scan_size) > end))
-        return 0;
+    const uint8_t *last = end - p.size();
 
-    const size_t length = end - start;
+    // all wildcards
+    if (!p.solid())
+        return begin;
 
-    for (size_t i = 0; i < length; ++i)
+    const uint8_t *cur = begin;
+    while (cur <= last)
     {
-        const uintptr_t current_end = start + i + scan_size;
-        if (current_end > end)
+        const uint8_t *hit = (const uint8_t *)memchr(cur + p.anchor1(), p.anchor1Byte(), (last - cur) + 1);
+        if (!hit)
             break;
 
-        if (!compare(reinterpret_cast<const char *>(start + i), pattern, mask.c_str()))
-            continue;
+        const uint8_t *candidate = hit - p.anchor1();
+        if (verifyScalar(candidate, p))
+            return candidate;
 
-        return start + i;
+        cur = candidate + 1;
     }
-    return 0;
+    return nullptr;
 }
 
-std::vector<uintptr_t> KittyScannerMgr::findBytesAll(const uintptr_t start, const uintptr_t end,
-                                                     const char *bytes, const std::string &mask) const
+// exact patterns with a skip table
+static const uint8_t *find_horspool(const uint8_t *begin, const uint8_t *end, const KittyPattern &p)
 {
-    std::vector<uintptr_t> local_list;
+    const size_t n = p.size();
+    if (size_t(end - begin) < n)
+        return nullptr;
 
-    if (!_pMem || start >= end || !bytes || mask.empty())
-        return local_list;
+    const uint8_t *bytes = p.bytes().data();
+    const uint8_t *skip = p.skipTable();
+    const uint8_t last_byte = bytes[n - 1];
+    const size_t last = size_t(end - begin) - n;
 
-    std::vector<char> buf(end - start, 0);
-    if (!_pMem->Read(start, &buf[0], buf.size()))
+    for (size_t i = 0; i <= last;)
     {
-        KITTY_LOGE("findBytesAll: failed to read into buffer.");
-        return local_list;
+        const uint8_t c = begin[i + n - 1];
+        if (c == last_byte && begin[i] == bytes[0] && memcmp(begin + i, bytes, n - 1) == 0)
+            return begin + i;
+
+        i += skip[c];
     }
+    return nullptr;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
 
-    uintptr_t curr_search_address = (uintptr_t)&buf[0];
-    const size_t scan_size = mask.length();
-    do
+__attribute__((target("sse2"))) static bool verify_sse2(const uint8_t *data, const KittyPattern &p)
+{
+    size_t i = 0;
+    for (; i + 16 <= p.size(); i += 16)
     {
-        if (!local_list.empty())
-            curr_search_address = local_list.back() + scan_size;
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p.bytes().data() + i));
+        __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p.mask().data() + i));
+        __m128i diff = _mm_and_si128(_mm_xor_si128(d, b), m);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF)
+            return false;
+    }
+    return verifyScalar(data, p, i);
+}
 
-        uintptr_t found = findInRange(curr_search_address, (uintptr_t(&buf[0]) + buf.size()), bytes, mask);
-        if (!found)
-            break;
+__attribute__((target("sse2"))) static const uint8_t *find_sse2(const uint8_t *begin, const uint8_t *end, const KittyPattern &p)
+{
+    if (size_t(end - begin) < p.size())
+        return nullptr;
 
-        local_list.push_back(found);
-    } while (true);
+    if (!p.solid())
+        return begin;
 
-    if (local_list.empty())
-        return local_list;
+    const uint8_t *last = end - p.size();
+    const __m128i v1 = _mm_set1_epi8(char(p.anchor1Byte()));
+    const __m128i v2 = _mm_set1_epi8(char(p.anchor2Byte()));
 
-    std::vector<uintptr_t> remote_list;
-    for (auto &it : local_list)
+    const uint8_t *cur = begin;
+    for (; last - cur >= 15; cur += 16)
     {
-        remote_list.push_back((it - (uintptr_t(&buf[0]))) + start);
+        __m128i d1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cur + p.anchor1()));
+        __m128i d2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cur + p.anchor2()));
+        unsigned bits = unsigned(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(d1, v1), _mm_cmpeq_epi8(d2, v2))));
+        while (bits)
+        {
+            const uint8_t *candidate = cur + __builtin_ctz(bits);
+            if (verify_sse2(candidate, p))
+                return candidate;
+            bits &= bits - 1;
+        }
     }
 
-    return remote_list;
+    for (; cur <= last; cur++)
+    {
+        if (cur[p.anchor1()] == p.anchor1Byte() && cur[p.anchor2()] == p.anchor2Byte() && verifyScalar(cur, p))
+            return cur;
+    }
+    return nullptr;
 }
 
-uintptr_t KittyScannerMgr::findBytesFirst(const uintptr_t start, const uintptr_t end, const char *bytes, const std::string &mask) const
+__attribute__((target("avx2"))) static bool verify_avx2(const uint8_t *data, const KittyPattern &p)
 {
-    if (!_pMem || start >= end || !bytes || mask.empty())
-        return 0;
+    size_t i = 0;
+    for (; i + 32 <= p.size(); i += 32)
+    {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p.bytes().data() + i));
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p.mask().data() + i));
+        __m256i diff = _mm256_and_si256(_mm256_xor_si256(d, b), m);
+        if (!_mm256_testz_si256(diff, diff))
+            return false;
+    }
+    return verifyScalar(data, p, i);
+}
+
+__attribute__((target("avx2"))) static const uint8_t *find_avx2(const uint8_t *begin, const uint8_t *end, const KittyPattern &p)
+{
+    if (size_t(end - begin) < p.size())
+        return nullptr;
 
-    std::vector<char> buf(end - start, 0);
-    if (!_pMem->Read(start, &buf[0], buf.size()))
+    if (!p.solid())
+        return begin;
+
+    const uint8_t *last = end - p.size();
+    const __m256i v1 = _mm256_set1_epi8(char(p.anchor1Byte()));
+    const __m256i v2 = _mm256_set1_epi8(char(p.anchor2Byte()));
+
+    const uint8_t *cur = begin;
+    for (; last - cur >= 31; cur += 32)
     {
-        KITTY_LOGE("findBytesFirst: failed to read into buffer.");
-        return 0;
+        __m256i d1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cur + p.anchor1()));
+        __m256i d2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cur + p.anchor2()));
+        unsigned bits = unsigned(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(d1, v1), _mm256_cmpeq_epi8(d2, v2))));
+        while (bits)
+        {
+            const uint8_t *candidate = cur + __builtin_ctz(bits);
+            if (verify_avx2(candidate, p))
+                return candidate;
+            bits &= bits - 1;
+        }
+    }
+
+    for (; cur <= last; cur++)
+    {
+        if (cur[p.anchor1()] == p.anchor1Byte() && cur[p.anchor2()] == p.anchor2Byte() && verifyScalar(cur, p))
+            return cur;
     }
+    return nullptr;
+}
 
-    uintptr_t local = findInRange((uintptr_t)&buf[0], (uintptr_t(&buf[0]) + buf.size()), bytes, mask);
-    if (local)
-        return (local - (uintptr_t(&buf[0]))) + start;
+#elif defined(__aarch64__) || defined(__ARM_NEON)
 
-    return 0;
+// 4 bits per byte mask of a compare result
+static inline uint64_t neon_movemask(uint8x16_t v)
+{
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(v), 4)), 0);
 }
 
-std::vector<uintptr_t> KittyScannerMgr::findHexAll(const uintptr_t start, const uintptr_t end, std::string hex, const std::string &mask) const
+static bool verify_neon(const uint8_t *data, const KittyPattern &p)
 {
-    std::vector<uintptr_t> list;
+    size_t i = 0;
+    for (; i + 16 <= p.size(); i += 16)
+    {
+        uint8x16_t d = vld1q_u8(data + i);
+        uint8x16_t b = vld1q_u8(p.bytes().data() + i);
+        uint8x16_t m = vld1q_u8(p.mask().data() + i);
+        if (neon_movemask(vandq_u8(veorq_u8(d, b), m)))
+            return false;
+    }
+    return verifyScalar(data, p, i);
+}
 
-    if (!_pMem || start >= end || mask.empty() || !KittyUtils::String::ValidateHex(hex))
-        return list;
+static const uint8_t *find_neon(const uint8_t *begin, const uint8_t *end, const KittyPattern &p)
+{
+    if (size_t(end - begin) < p.size())
+        return nullptr;
 
-    const size_t scan_size = mask.length();
-    if ((hex.length() / 2) != scan_size)
-        return list;
+    if (!p.solid())
+        return begin;
 
-    std::vector<char> pattern(scan_size);
-    KittyUtils::dataFromHex(hex, &pattern[0]);
+    const uint8_t *last = end - p.size();
+    const uint8x16_t v1 = vdupq_n_u8(p.anchor1Byte());
+    const uint8x16_t v2 = vdupq_n_u8(p.anchor2Byte());
 
-    list = findBytesAll(start, end, pattern.data(), mask);
-    return list;
+    const uint8_t *cur = begin;
+    for (; last - cur >= 15; cur += 16)
+    {
+        uint8x16_t d1 = vld1q_u8(cur + p.anchor1());
+        uint8x16_t d2 = vld1q_u8(cur + p.anchor2());
+        uint64_t bits = neon_movemask(vandq_u8(vceqq_u8(d1, v1), vceqq_u8(d2, v2)));
+        while (bits)
+        {
+            int k = __builtin_ctzll(bits) >> 2;
+            const uint8_t *candidate = cur + k;
+            if (verify_neon(candidate, p))
+                return candidate;
+            bits &= ~(uint64_t(0xF) << (k * 4));
+        }
+    }
+
+    for (; cur <= last; cur++)
+    {
+        if (cur[p.anchor1()] == p.anchor1Byte() && cur[p.anchor2()] == p.anchor2Byte() && verifyScalar(cur, p))
+            return cur;
+    }
+    return nullptr;
 }
 
-uintptr_t KittyScannerMgr::findHexFirst(const uintptr_t start, const uintptr_t end, std::string hex, const std::string &mask) const
+#endif
+
+static find_fn_t selectFindFn()
 {
-    if (!_pMem || start >= end || mask.empty() || !KittyUtils::String::ValidateHex(hex))
-        return 0;
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return find_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return find_sse2;
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+    return find_neon;
+#endif
+    return find_scalar;
+}
 
-    const size_t scan_size = mask.length();
-    if ((hex.length() / 2) != scan_size)
-        return 0;
+// first match of pattern within [begin, end)
+static inline const uint8_t *findInRange(const uint8_t *begin, const uint8_t *end, const KittyPattern &pattern)
+{
+    static const find_fn_t find_fn = selectFindFn();
 
-    std::vector<char> pattern(scan_size);
-    KittyUtils::dataFromHex(hex, &pattern[0]);
+    // anchored vector compare outruns skip tables, Horspool only beats the scalar fallback
+    if (find_fn == find_scalar && pattern.skipTable())
+        return find_horspool(begin, end, pattern);
 
-    return findBytesFirst(start, end, pattern.data(), mask);
+    return find_fn(begin, end, pattern);
 }
 
-std::vector<uintptr_t> KittyScannerMgr::findIdaPatternAll(const uintptr_t start, const uintptr_t end, const std::string& pattern)
+// resident only scan state, file backed maps are always read since their pages may be in page cache
+// without being faulted into the scanned process
+struct resident_filter_t
 {
-    std::vector<uintptr_t> list;
+    const KittyPageMap *pageMap = nullptr;
+    std::shared_ptr<const KittyMemoryEx::ProcMapIndex> maps;
+};
 
-    if (!_pMem || start >= end)
-        return list;
+static resident_filter_t residentFilter(const IKittyMemOp *pMem, const KittyPageMap *pageMap,
+                                        const std::vector<KittyMemoryEx::ProcMap> *maps = nullptr)
+{
+    resident_filter_t filter;
+    if (!pageMap)
+        return filter;
+
+    filter.pageMap = pageMap;
+    filter.maps = maps ? std::make_shared<const KittyMemoryEx::ProcMapIndex>(*maps)
+                       : std::make_shared<const KittyMemoryEx::ProcMapIndex>(pMem->processID());
+    return filter;
+}
 
-    std::string mask;
-    std::vector<char> bytes;
+// reads [address, address + len) into dst, bytes that fail to read are zero filled
+// with a resident filter only resident pages are read, the rest is zero filled too
+// returns false if nothing could be read
+static bool readChunk(IKittyMemOp *pMem, const resident_filter_t &resident, uintptr_t address, char *dst, size_t len)
+{
+    // reads skip unreadable pages anywhere in a range, not only at its end
+    memset(dst, 0, len);
+
+    PageResidency residency;
+    if (!resident.pageMap || !residency.query(*resident.pageMap, address, address + len, resident.maps.get()))
+        return pMem->Read(address, dst, len) != 0;
+
+    std::vector<mem_request_t> requests;
+    for (auto &range : residency.residentRanges())
+        requests.emplace_back(range.first, dst + (range.first - address), size_t(range.second - range.first));
+
+    // never touched pages hold nothing to find
+    if (requests.empty())
+        return true;
 
-    const size_t pattren_len = pattern.length();
-    for (std::size_t i = 0; i < pattren_len; i++)
+    return pMem->ReadBatch(requests) != 0;
+}
+
+// streams [start, end) through buf in chunks overlapping by pattern size - 1
+// bytes that fail to read are scanned as zeros, returns false if nothing could be read
+static bool scanRange(IKittyMemOp *pMem, const resident_filter_t &resident, uintptr_t start, uintptr_t end,
+                      const KittyPattern &pattern, bool firstOnly, std::vector<char> &buf, std::vector<uintptr_t> *out)
+{
+    const size_t overlap = pattern.size() - 1;
+    const size_t chunk_size = std::max(size_t(KT_SCAN_CHUNK_SIZE), pattern.size());
+    if (buf.size() < chunk_size + overlap)
+        buf.resize(chunk_size + overlap);
+
+    const uint8_t *buf_start = reinterpret_cast<const uint8_t *>(buf.data());
+    bool any_read = false;
+    size_t carried = 0;
+    uintptr_t read_address = start;
+    uintptr_t next_match = start; // matches don't overlap
+
+    while (read_address < end)
     {
-        if (pattern[i] == ' ') continue;
-		
-        if (pattern[i] == '?')
-        {
-            bytes.push_back(0);
-            mask += '?';
-        }
-        else if (pattren_len > i + 1 && std::isxdigit(pattern[i]) && std::isxdigit(pattern[i+1]))
+        const size_t len = std::min(chunk_size, size_t(end - read_address));
+        char *dst = buf.data() + carried;
+
+        if (readChunk(pMem, resident, read_address, dst, len))
+            any_read = true;
+
+        // buffer holds [window_start, read_address + len)
+        const uintptr_t window_start = read_address - carried;
+        const uint8_t *window_end = buf_start + carried + len;
+        const uint8_t *cur = buf_start + (std::max(next_match, window_start) - window_start);
+
+        while (const uint8_t *found = findInRange(cur, window_end, pattern))
         {
-            bytes.push_back(std::stoi(pattern.substr(i++, 2), nullptr, 16));
-            mask += 'x';
+            out->push_back(window_start + uintptr_t(found - buf_start));
+            if (firstOnly)
+                return true;
+
+            cur = found + pattern.size();
         }
+        next_match = window_start + uintptr_t(cur - buf_start);
+
+        // keep tail for matches crossing into next chunk
+        read_address += len;
+        carried = std::min(overlap, carried + len);
+        memmove(buf.data(), window_end - carried, carried);
     }
 
-    if (bytes.empty() || mask.empty() || bytes.size() != mask.size())
-        return list;
+    return any_read;
+}
 
-    list = findBytesAll(start, end, bytes.data(), mask);
-    return list;
+std::vector<uintptr_t> KittyScannerMgr::findBytesAll(const uintptr_t start, const uintptr_t end,
+                                                     const char *bytes, const std::string &mask) const
+{
+    if (!_pMem || start >= end || !bytes || mask.empty())
+        return {};
+
+    return findPatternAll(start, end, KittyPattern(bytes, mask));
 }
 
-uintptr_t KittyScannerMgr::findIdaPatternFirst(const uintptr_t start, const uintptr_t end, const std::string& pattern)
+uintptr_t KittyScannerMgr::findBytesFirst(const uintptr_t start, const uintptr_t end, const char *bytes, const std::string &mask) const
 {
-    if (!_pMem || start >= end)
+    if (!_pMem || start >= end || !bytes || mask.empty())
         return 0;
 
-    std::string mask;
-    std::vector<char> bytes;
+    return findPatternFirst(start, end, KittyPattern(bytes, mask));
+}
+
+std::vector<uintptr_t> KittyScannerMgr::findPatternAll(const uintptr_t start, const uintptr_t end, const KittyPattern &pattern) const
+{
+    std::vector<uintptr_t> local_list;
+
+    if (!_pMem || start >= end || !pattern.isValid())
+        return local_list;
 
-    const size_t pattren_len = pattern.length();
-    for (std::size_t i = 0; i < pattren_len; i++)
+    std::vector<char> buf;
+    if (!scanRange(_pMem, residentFilter(_pMem, _pPageMap), start, end, pattern, false, buf, &local_list))
     {
-        if (pattern[i] == ' ') continue;
-		
-        if (pattern[i] == '?')
-        {
-            bytes.push_back(0);
-            mask += '?';
-        }
-        else if (pattren_len > i + 1 && std::isxdigit(pattern[i]) && std::isxdigit(pattern[i+1]))
-        {
-            bytes.push_back(std::stoi(pattern.substr(i++, 2), nullptr, 16));
-            mask += 'x';
-        }
+        KITTY_LOGE("findPatternAll: failed to read into buffer.");
+        local_list.clear();
     }
 
-    if (bytes.empty() || mask.empty() || bytes.size() != mask.size())
+    return local_list;
+}
+
+uintptr_t KittyScannerMgr::findPatternFirst(const uintptr_t start, const uintptr_t end, const KittyPattern &pattern) const
+{
+    if (!_pMem || start >= end || !pattern.isValid())
+        return 0;
+
+    std::vector<char> buf;
+    std::vector<uintptr_t> found;
+    if (!scanRange(_pMem, residentFilter(_pMem, _pPageMap), start, end, pattern, true, buf, &found))
+    {
+        KITTY_LOGE("findPatternFirst: failed to read into buffer.");
         return 0;
+    }
 
-    return findBytesFirst(start, end, bytes.data(), mask);
+    return found.empty() ? 0 : found.front();
 }
 
-std::vector<uintptr_t> KittyScannerMgr::findDataAll(const uintptr_t start, const uintptr_t end, const void *data, size_t size) const
+std::vector<uintptr_t> KittyScannerMgr::findHexAll(const uintptr_t start, const uintptr_t end, std::string hex, const std::string &mask) const
 {
-    std::vector<uintptr_t> list;
+    if (!_pMem || start >= end || mask.empty())
+        return {};
 
-    if (!_pMem || start >= end || !data || size < 1)
-        return list;
+    KittyPattern pattern = KittyPattern::fromHex(hex, mask);
+    if (!pattern.isValid())
+        return {};
 
-    std::string mask(size, 'x');
+    return findPatternAll(start, end, pattern);
+}
 
-    list = findBytesAll(start, end, (const char *)data, mask);
-    return list;
+uintptr_t KittyScannerMgr::findHexFirst(const uintptr_t start, const uintptr_t end, std::string hex, const std::string &mask) const
+{
+    if (!_pMem || start >= end || mask.empty())
+        return 0;
+
+    KittyPattern pattern = KittyPattern::fromHex(hex, mask);
+    if (!pattern.isValid())
+        return 0;
+
+    return findPatternFirst(start, end, pattern);
 }
 
-uintptr_t KittyScannerMgr::findDataFirst(const uintptr_t start, const uintptr_t end, const void *data, size_t size) const
+std::vector<uintptr_t> KittyScannerMgr::findIdaPatternAll(const uintptr_t start, const uintptr_t end, const std::string& pattern)
 {
-    if (!_pMem || start >= end || !data || size < 1)
+    if (!_pMem || start >= end)
+        return {};
+
+    KittyPattern compiled = KittyPattern::fromIda(pattern);
+    if (!compiled.isValid())
+        return {};
+
+    return findPatternAll(start, end, compiled);
+}
+
+uintptr_t KittyScannerMgr::findIdaPatternFirst(const uintptr_t start, const uintptr_t end, const std::string& pattern)
+{
+    if (!_pMem || start >= end)
         return 0;
 
-    std::string mask(size, 'x');
+    KittyPattern compiled = KittyPattern::fromIda(pattern);
+    if (!compiled.isValid())
+        return 0;
 
-    return findBytesFirst(start, end, (const char *)data, mask);
+    return findPatternFirst(start, end, compiled);
 }
 
-/* ======================= ElfScanner ======================= */
+std::vector<uintptr_t> KittyScannerMgr::findDataAll(const uintptr_t start, const uintptr_t end, const void *data, size_t size) const
+{
+    if (!_pMem || start >= end || !data || size < 1)
+        return {};
 
-// refs https://gist.github.com/resilar/24bb92087aaec5649c9a2afc0b4350c8
+    return findPatternAll(start, end, KittyPattern(data, size));
+}
 
-ElfScanner::ElfScanner(IKittyMemOp *pMem, uintptr_t elfBase)
+uintptr_t KittyScannerMgr::findDataFirst(const uintptr_t start, const uintptr_t end, const void *data, size_t size) const
 {
-    _pMem = nullptr;
-    _elfBase = 0;
-    _ehdr = {};
-    _phdr = 0;
-    _loads = 0;
-    _loadBias = 0;
-    _loadSize = 0;
-    _bss = 0;
-    _bssSize = 0;
-    _dynamic = 0;
-    _stringTable = 0;
-    _symbolTable = 0;
-    _strsz = 0;
-    _syment = 0;
-    _symbols_init = false;
+    if (!_pMem || start >= end || !data || size < 1)
+        return 0;
 
-    if (!pMem || !elfBase)
-        return;
+    return findPatternFirst(start, end, KittyPattern(data, size));
+}
 
-    _pMem = pMem;
-    _elfBase = elfBase;
+/* ======================= PatternSet ======================= */
+
+bool PatternSet::add(const std::string &name, const std::string &pattern)
+{
+    return add(name, KittyPattern::fromIda(pattern));
+}
 
-    // read ELF header
-    if (!_pMem->Read(elfBase, &_ehdr, sizeof(_ehdr)))
+bool PatternSet::add(const std::string &name, const char *bytes, const std::string &mask)
+{
+    return add(name, KittyPattern(bytes, mask));
+}
+
+bool PatternSet::add(const std::string &name, const KittyPattern &pattern)
+{
+    if (!pattern.isValid() || _names.count(name))
+        return false;
+
+    entry_t entry;
+    entry.name = name;
+    entry.bytes = pattern.bytes();
+    entry.mask = pattern.mask();
+
+    // rarest run of four adjacent fixed bytes, else pair, else single byte
+    int best_quad = INT32_MAX, best_pair = INT32_MAX, best_single = INT32_MAX;
+    size_t quad_at = 0, pair_at = 0, single_at = 0;
+    for (size_t i = 0; i < entry.bytes.size(); i++)
     {
-        KITTY_LOGD("ElfScanner: failed to read ELF (%p) header.", (void *)elfBase);
-        return;
+        int score = 0;
+        for (size_t j = 0; j < 4 && i + j < entry.bytes.size() && entry.mask[i + j]; j++)
+        {
+            score += KittyPattern::byteScore(entry.bytes[i + j]);
+            if (j == 0 && score < best_single)
+                best_single = score, single_at = i;
+            else if (j == 1 && score < best_pair)
+                best_pair = score, pair_at = i;
+            else if (j == 3 && score < best_quad)
+                best_quad = score, quad_at = i;
+        }
     }
 
-    // verify ELF header
-    if (memcmp(_ehdr.e_ident, "\177ELF", 4) != 0)
+    const uint32_t idx = uint32_t(_patterns.size());
+    if (best_quad != INT32_MAX)
     {
-        KITTY_LOGD("ElfScanner: (%p) is not a valid ELF.", (void *)elfBase);
-        return;
+        entry.anchor = quad_at;
+        uint32_t quad = 0;
+        memcpy(&quad, &entry.bytes[quad_at], sizeof(quad));
+        uint32_t &head = _quads[quadHash(quad)];
+        entry.next = head, head = idx;
+        _quadFilter[quadHash(quad)] = true;
     }
-
-    // check ELF bit
-    if (_ehdr.e_ident[EI_CLASS] != ELF_EICLASS_)
+    else if (best_pair != INT32_MAX)
     {
-        KITTY_LOGD("ElfScanner: ELF class mismatch (%p).", (void *)elfBase);
-        return;
+        entry.anchor = pair_at;
+        const uint16_t pair = uint16_t(entry.bytes[pair_at] | (entry.bytes[pair_at + 1] << 8));
+        uint32_t &head = _pairs[pair];
+        entry.next = head, head = idx;
+        _pairFilter[pair] = true;
     }
-
-    // check common header values
-    if (!_ehdr.e_phnum || !_ehdr.e_phentsize || !_ehdr.e_shnum || !_ehdr.e_shentsize)
+    else if (best_single != INT32_MAX)
     {
-        KITTY_LOGD("ElfScanner: Invalid header values (%p).", (void *)elfBase);
-        return;
+        entry.anchor = single_at;
+        uint32_t &head = _singles[entry.bytes[single_at]];
+        entry.next = head, head = idx;
     }
-
-    _phdr = elfBase + _ehdr.e_phoff;
-    
-    // read all program headers
-    std::vector<char> phdrs_buf(_ehdr.e_phnum * _ehdr.e_phentsize);
-    if (!_pMem->Read(_phdr, &phdrs_buf[0], phdrs_buf.size()))
+    else
     {
-        KITTY_LOGD("ElfScanner: failed to read ELF (%p) program headers.", (void *)elfBase);
-        return;
+        _unanchored.push_back(idx);
     }
 
-    // find load bias
-    uintptr_t min_vaddr = UINTPTR_MAX, max_vaddr = 0;
-    uintptr_t load_vaddr = 0, load_memsz = 0, load_filesz = 0;
-    for (ElfW_(Half) i = 0; i < _ehdr.e_phnum; i++)
-    {
-        ElfW_(Phdr) phdr_entry = {};
-        memcpy(&phdr_entry, phdrs_buf.data() + (i * _ehdr.e_phentsize), _ehdr.e_phentsize);
-        _phdrs.push_back(phdr_entry);
+    _maxSize = std::max(_maxSize, entry.bytes.size());
+    _names[name] = idx;
+    _patterns.push_back(std::move(entry));
+    return true;
+}
 
-        if (phdr_entry.p_type == PT_LOAD)
-        {
-            _loads++;
+void PatternSet::clear()
+{
+    _patterns.clear();
+    _names.clear();
+    _maxSize = 0;
+    std::fill(_quads.begin(), _quads.end(), UINT32_MAX);
+    std::fill(_pairs.begin(), _pairs.end(), UINT32_MAX);
+    std::fill(_singles.begin(), _singles.end(), UINT32_MAX);
+    _quadFilter.reset();
+    _pairFilter.reset();
+    _unanchored.clear();
+}
 
-            load_vaddr = phdr_entry.p_vaddr;
+bool KittyScannerMgr::scanPatternSet(const uintptr_t start, const uintptr_t end, const PatternSet &set,
+                                     bool firstOnly, std::vector<std::vector<uintptr_t>> *out) const
+{
+    const size_t count = set._patterns.size();
+    out->assign(count, {});
+
+    // first address each pattern may still match at, skips starts already checked
+    // in the previous chunk and keeps matches of a pattern from overlapping
+    std::vector<uintptr_t> next_match(count, start);
+    std::vector<bool> done(count, false);
+    size_t remaining = count - set._unanchored.size();
+
+    const size_t overlap = set._maxSize - 1;
+    const size_t chunk_size = std::max(size_t(KT_SCAN_CHUNK_SIZE), set._maxSize);
+    std::vector<char> buf(chunk_size + overlap);
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(buf.data());
+    const resident_filter_t resident = residentFilter(_pMem, _pPageMap);
+
+    bool any_read = false;
+    size_t carried = 0;
+    uintptr_t read_address = start;
+
+    // with firstOnly stop once every anchored pattern is found and something was readable
+    while (read_address < end && (!firstOnly || remaining || !any_read))
+    {
+        const size_t len = std::min(chunk_size, size_t(end - read_address));
+        char *dst = buf.data() + carried;
+
+        if (readChunk(_pMem, resident, read_address, dst, len))
+            any_read = true;
+
+        const uintptr_t window_start = read_address - carried;
+        const size_t window_len = carried + len;
+
+        auto check = [&](uint32_t idx, size_t pos)
+        {
+            const PatternSet::entry_t &e = set._patterns[idx];
+            if (done[idx] || pos < e.anchor)
+                return;
+
+            const size_t at = pos - e.anchor;
+            const uintptr_t address = window_start + at;
+            if (at + e.bytes.size() > window_len || address < next_match[idx])
+                return;
+
+            for (size_t i = 0; i < e.bytes.size(); i++)
+            {
+                if ((data[at + i] ^ e.bytes[i]) & e.mask[i])
+                    return;
+            }
+
+            (*out)[idx].push_back(address);
+            next_match[idx] = address + e.bytes.size();
+            if (firstOnly)
+            {
+                done[idx] = true;
+                remaining--;
+            }
+        };
+
+        for (size_t pos = 0; pos < window_len; pos++)
+        {
+            for (uint32_t idx = set._singles[data[pos]]; idx != UINT32_MAX; idx = set._patterns[idx].next)
+                check(idx, pos);
+
+            if (pos + 1 < window_len)
+            {
+                const uint16_t pair = uint16_t(data[pos] | (data[pos + 1] << 8));
+                if (set._pairFilter[pair])
+                {
+                    for (uint32_t idx = set._pairs[pair]; idx != UINT32_MAX; idx = set._patterns[idx].next)
+                        check(idx, pos);
+                }
+            }
+
+            if (pos + 3 < window_len)
+            {
+                uint32_t quad = 0;
+                memcpy(&quad, data + pos, sizeof(quad));
+                const uint32_t hash = PatternSet::quadHash(quad);
+                if (set._quadFilter[hash])
+                {
+                    for (uint32_t idx = set._quads[hash]; idx != UINT32_MAX; idx = set._patterns[idx].next)
+                        check(idx, pos);
+                }
+            }
+        }
+
+        // every start that fits inside this window has been checked
+        for (size_t i = 0; i < count; i++)
+        {
+            const size_t size = set._patterns[i].bytes.size();
+            if (window_len >= size)
+                next_match[i] = std::max(next_match[i], window_start + (window_len - size) + 1);
+        }
+
+        // keep tail for matches crossing into next chunk
+        read_address += len;
+        carried = std::min(overlap, window_len);
+        memmove(buf.data(), buf.data() + window_len - carried, carried);
+    }
+
+    if (!any_read)
+        return false;
+
+    // wildcard only patterns match everywhere
+    for (uint32_t idx : set._unanchored)
+    {
+        const size_t size = set._patterns[idx].bytes.size();
+        for (uintptr_t address = start; address + size <= end; address += size)
+        {
+            (*out)[idx].push_back(address);
+            if (firstOnly)
+                break;
+        }
+    }
+
+    return true;
+}
+
+std::unordered_map<std::string, std::vector<uintptr_t>> KittyScannerMgr::findPatternSetAll(const uintptr_t start, const uintptr_t end, const PatternSet &patterns) const
+{
+    std::unordered_map<std::string, std::vector<uintptr_t>> results;
+
+    if (!_pMem || start >= end || patterns.empty())
+        return results;
+
+    std::vector<std::vector<uintptr_t>> found;
+    if (!scanPatternSet(start, end, patterns, false, &found))
+    {
+        KITTY_LOGE("findPatternSetAll: failed to read into buffer.");
+        return results;
+    }
+
+    for (size_t i = 0; i < found.size(); i++)
+        results[patterns._patterns[i].name] = std::move(found[i]);
+
+    return results;
+}
+
+std::unordered_map<std::string, uintptr_t> KittyScannerMgr::findPatternSetFirst(const uintptr_t start, const uintptr_t end, const PatternSet &patterns) const
+{
+    std::unordered_map<std::string, uintptr_t> results;
+
+    if (!_pMem || start >= end || patterns.empty())
+        return results;
+
+    std::vector<std::vector<uintptr_t>> found;
+    if (!scanPatternSet(start, end, patterns, true, &found))
+    {
+        KITTY_LOGE("findPatternSetFirst: failed to read into buffer.");
+        return results;
+    }
+
+    for (size_t i = 0; i < found.size(); i++)
+        results[patterns._patterns[i].name] = found[i].empty() ? 0 : found[i].front();
+
+    return results;
+}
+
+std::vector<uintptr_t> KittyScannerMgr::scanProcess(const std::string &pattern,
+                                                    const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter,
+                                                    size_t threads) const
+{
+    return scanProcess(KittyPattern::fromIda(pattern), filter, threads);
+}
+
+std::vector<uintptr_t> KittyScannerMgr::scanProcess(const char *bytes, const std::string &mask,
+                                                    const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter,
+                                                    size_t threads) const
+{
+    return scanProcess(KittyPattern(bytes, mask), filter, threads);
+}
+
+std::vector<uintptr_t> KittyScannerMgr::scanProcess(const KittyPattern &pattern,
+                                                    const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter,
+                                                    size_t threads) const
+{
+    std::vector<uintptr_t> list;
+
+    if (!_pMem || _pMem->processID() < 1 || !pattern.isValid())
+        return list;
+
+    struct work_unit_t
+    {
+        size_t region;
+        uintptr_t start, end;
+    };
+
+    // split readable regions into units, each unit also reads pattern size - 1 bytes
+    // past its end so matches starting inside it are complete
+    const uintptr_t unit_size = uintptr_t(KT_SCAN_CHUNK_SIZE) * 4;
+    std::vector<KittyMemoryEx::ProcMap> regions;
+    std::vector<work_unit_t> units;
+    const auto maps = KittyMemoryEx::getAllMaps(_pMem->processID());
+    for (auto &it : maps)
+    {
+        if (!it.readable || it.length < pattern.size() || (filter && !filter(it)))
+            continue;
+
+        for (uintptr_t addr = it.startAddress; addr < it.endAddress; addr += unit_size)
+        {
+            uintptr_t unit_end = std::min(addr + unit_size + pattern.size() - 1, uintptr_t(it.endAddress));
+            units.push_back({regions.size(), addr, unit_end});
+        }
+        regions.push_back(it);
+    }
+
+    if (units.empty())
+        return list;
+
+    const resident_filter_t resident = residentFilter(_pMem, _pPageMap, &maps);
+
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min(threads, units.size());
+
+    // workers pull the next unit until none are left, each unit's results are owned by one worker
+    std::vector<std::vector<uintptr_t>> unit_results(units.size());
+    std::atomic<size_t> next_unit(0);
+    auto worker = [&]()
+    {
+        std::vector<char> buf;
+        for (size_t i = next_unit++; i < units.size(); i = next_unit++)
+        {
+            if (!scanRange(_pMem, resident, units[i].start, units[i].end, pattern, false, buf, &unit_results[i]))
+                unit_results[i].clear();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; i++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    // stitch units in address order, a unit is scanned from its start so if the previous
+    // unit's last match runs over one of its matches, rescan it from where findBytesAll would continue
+    std::vector<char> buf;
+    std::vector<uintptr_t> rescan;
+    size_t region = size_t(-1);
+    uintptr_t next_match = 0;
+    for (size_t i = 0; i < units.size(); i++)
+    {
+        if (units[i].region != region)
+        {
+            region = units[i].region;
+            next_match = 0;
+        }
+
+        const std::vector<uintptr_t> *results = &unit_results[i];
+        if (!results->empty() && results->front() < next_match)
+        {
+            rescan.clear();
+            scanRange(_pMem, resident, next_match, units[i].end, pattern, false, buf, &rescan);
+            results = &rescan;
+        }
+
+        for (uintptr_t addr : *results)
+        {
+            list.push_back(addr);
+            next_match = addr + pattern.size();
+        }
+    }
+
+    return list;
+}
+
+/* ======================= ElfScanner ======================= */
+
+// refs https://gist.github.com/resilar/24bb92087aaec5649c9a2afc0b4350c8
+
+ElfScanner::ElfScanner(IKittyMemOp *pMem, uintptr_t elfBase,
+                       const std::shared_ptr<const KittyMemoryEx::ProcMapIndex> &maps)
+{
+    _pMem = nullptr;
+    _elfBase = 0;
+    _ehdr = {};
+    _phdr = 0;
+    _loads = 0;
+    _loadBias = 0;
+    _loadSize = 0;
+    _bss = 0;
+    _bssSize = 0;
+    _dynamic = 0;
+    _stringTable = 0;
+    _symbolTable = 0;
+    _strsz = 0;
+    _syment = 0;
+    _symbols_init = false;
+    _gnuHash = 0;
+    _sysvHash = 0;
+    _hashes_init = false;
+    _gnuSymOffset = 0;
+    _gnuBloomShift = 0;
+    _sysvNChain = 0;
+    _symbolCount_init = false;
+    _symbolCount = 0;
+    _segments_init = false;
+
+    if (!pMem || !elfBase)
+        return;
+
+    _pMem = pMem;
+    _elfBase = elfBase;
+    _maps = maps;
+
+    // ELF header and program headers usually share the first page
+    std::vector<char> first_page(KT_PAGE_SIZE);
+    size_t first_page_sz = _pMem->Read(elfBase, first_page.data(), first_page.size());
+    if (first_page_sz < sizeof(_ehdr))
+    {
+        KITTY_LOGD("ElfScanner: failed to read ELF (%p) header.", (void *)elfBase);
+        return;
+    }
+
+    memcpy(&_ehdr, first_page.data(), sizeof(_ehdr));
+
+    // verify ELF header
+    if (memcmp(_ehdr.e_ident, "\177ELF", 4) != 0)
+    {
+        KITTY_LOGD("ElfScanner: (%p) is not a valid ELF.", (void *)elfBase);
+        return;
+    }
+
+    // check ELF bit
+    if (_ehdr.e_ident[EI_CLASS] != ELF_EICLASS_)
+    {
+        KITTY_LOGD("ElfScanner: ELF class mismatch (%p).", (void *)elfBase);
+        return;
+    }
+
+    // check common header values
+    if (!_ehdr.e_phnum || !_ehdr.e_phentsize || !_ehdr.e_shnum || !_ehdr.e_shentsize)
+    {
+        KITTY_LOGD("ElfScanner: Invalid header values (%p).", (void *)elfBase);
+        return;
+    }
+
+    _phdr = elfBase + _ehdr.e_phoff;
+    
+    // read all program headers
+    std::vector<char> phdrs_buf(_ehdr.e_phnum * _ehdr.e_phentsize);
+    if (_ehdr.e_phoff + phdrs_buf.size() <= first_page_sz)
+    {
+        memcpy(phdrs_buf.data(), first_page.data() + _ehdr.e_phoff, phdrs_buf.size());
+    }
+    else if (!_pMem->Read(_phdr, &phdrs_buf[0], phdrs_buf.size()))
+    {
+        KITTY_LOGD("ElfScanner: failed to read ELF (%p) program headers.", (void *)elfBase);
+        return;
+    }
+
+    // find load bias
+    uintptr_t min_vaddr = UINTPTR_MAX, max_vaddr = 0;
+    uintptr_t load_vaddr = 0, load_memsz = 0, load_filesz = 0;
+    for (ElfW_(Half) i = 0; i < _ehdr.e_phnum; i++)
+    {
+        ElfW_(Phdr) phdr_entry = {};
+        memcpy(&phdr_entry, phdrs_buf.data() + (i * _ehdr.e_phentsize), _ehdr.e_phentsize);
+        _phdrs.push_back(phdr_entry);
+
+        if (phdr_entry.p_type == PT_LOAD)
+        {
+            _loads++;
+
+            load_vaddr = phdr_entry.p_vaddr;
             load_memsz = phdr_entry.p_memsz;
             load_filesz = phdr_entry.p_filesz;
 
@@ -374,6 +1093,13 @@ ElfScanner::ElfScanner(IKittyMemOp *pMem, uintptr_t elfBase)
                 case DT_SYMENT: // symbol entry size
                     _syment = dyn.d_un.d_val;
                     break;
+                    // optional, for symbol lookup
+                case DT_GNU_HASH:
+                    _gnuHash = dyn.d_un.d_ptr;
+                    break;
+                case DT_HASH:
+                    _sysvHash = dyn.d_un.d_ptr;
+                    break;
                 default:
                     break;
                 }
@@ -400,79 +1126,748 @@ ElfScanner::ElfScanner(IKittyMemOp *pMem, uintptr_t elfBase)
 
     fix_table_address(_stringTable);
     fix_table_address(_symbolTable);
+    fix_table_address(_gnuHash);
+    fix_table_address(_sysvHash);
+}
+
+void ElfScanner::initSegments() const
+{
+    if (_segments_init || !_pMem || !_loadSize)
+        return;
+
+    _segments_init = true;
+
+    auto maps = _maps ? _maps : std::make_shared<const KittyMemoryEx::ProcMapIndex>(_pMem->processID());
+    _maps.reset();
 
     bool fixBSS = !_bss;
 
-    auto p_maps = KittyMemoryEx::getAllMaps(_pMem->processID());
-    for (auto& it : p_maps)
+    _segments = maps->getMapsInRange(_elfBase, _elfBase + _loadSize);
+    for (auto &it : _segments)
     {
-        if (it.startAddress >= _elfBase && it.endAddress <= (_elfBase + _loadSize))
+        if (fixBSS && it.pathname == "[anon:.bss]")
         {
-            _segments.push_back(it);
-            if (fixBSS && it.pathname == "[anon:.bss]")
-            {
-                if (!_bss)
-                    _bss = it.startAddress;
+            if (!_bss)
+                _bss = it.startAddress;
 
-                _bssSize = it.endAddress - _bss;
-            }
+            _bssSize = it.endAddress - _bss;
         }
-
-        if (it.endAddress > (_elfBase + _loadSize))
-            break;
     }
 
     if (!_segments.empty())
         _base_segment = _segments.front();
 }
 
+bool ElfScanner::loadSymbolIndex()
+{
+    if (_symbolIndex)
+        return true;
+
+    if (!isValid())
+        return false;
+
+    const size_t sym_count = symbolCount();
+    if (!sym_count)
+    {
+        KITTY_LOGD("ElfScanner: unknown symbol count of ELF (%p).", (void *)_elfBase);
+        return false;
+    }
+
+    auto index = std::make_shared<symbol_index_t>();
+
+    std::vector<char> symbol_table_buff(sym_count * _syment, 0);
+    index->strtab.resize(_strsz, 0);
+
+    mem_request_t requests[2] = {
+        {_symbolTable, symbol_table_buff.data(), symbol_table_buff.size()},
+        {_stringTable, index->strtab.data(), index->strtab.size()}};
+
+    // a short read may have skipped pages anywhere in a table, only whole tables can be parsed
+    _pMem->ReadBatch(requests, 2);
+    if (requests[0].result != requests[0].len || requests[1].result != requests[1].len)
+    {
+        KITTY_LOGD("ElfScanner: failed to read symbol tables of ELF (%p).", (void *)_elfBase);
+        return false;
+    }
+
+    const char *strtab = index->strtab.data();
+    index->entries.reserve(sym_count);
+    index->names.reserve(sym_count);
+
+    for (size_t i = 0; i < sym_count; i++)
+    {
+        ElfW_(Sym) sym = {};
+        memcpy(&sym, symbol_table_buff.data() + i * _syment, std::min(sizeof(sym), _syment));
+        if (intptr_t(sym.st_name) <= 0 || intptr_t(sym.st_value) <= 0 || sym.st_name >= _strsz)
+            continue;
+
+        std::string_view name(strtab + sym.st_name, strnlen(strtab + sym.st_name, _strsz - sym.st_name));
+        if (name.empty())
+            continue;
+
+        uintptr_t address = sym.st_value < _loadBias ? _loadBias + sym.st_value : sym.st_value;
+        index->entries.emplace_back(address, name);
+        index->names.emplace(name, address);
+    }
+
+    _symbolIndex = std::move(index);
+    return true;
+}
+
 std::vector<std::pair<uintptr_t, std::string>> ElfScanner::symbols()
 {
-    if (!_symbols_init && isValid() && _stringTable > _symbolTable)
+    if (!_symbols_init && loadSymbolIndex())
     {
         _symbols_init = true;
-        auto get_sym_address = [&](const ElfW_(Sym) * sym_ent) -> uintptr_t
+        _symbols.reserve(_symbolIndex->entries.size());
+        for (auto &it : _symbolIndex->entries)
+            _symbols.emplace_back(it.first, std::string(it.second));
+
+        if (_fileSymbolIndex)
         {
-            return sym_ent->st_value < _loadBias ? _loadBias + sym_ent->st_value : sym_ent->st_value;
-        };
+            for (auto &it : _fileSymbolIndex->entries)
+            {
+                if (_symbolIndex->names.find(it.second) == _symbolIndex->names.end())
+                    _symbols.emplace_back(it.first, std::string(it.second));
+            }
+        }
+    }
+
+    return _symbols;
+}
+
+bool ElfScanner::loadFileSymbols()
+{
+    if (_fileSymbolIndex)
+        return true;
+
+    if (!isValid())
+        return false;
+
+    const KittyMemoryEx::ProcMap base_segment = baseSegment();
+    if (base_segment.pathname.empty() || base_segment.pathname[0] != '/')
+    {
+        KITTY_LOGD("ElfScanner: ELF (%p) has no backing file.", (void *)_elfBase);
+        return false;
+    }
+
+    KittyIOFile file(base_segment.pathname, O_RDONLY);
+    if (!file.Open())
+    {
+        KITTY_LOGD("ElfScanner: Couldn't open %s, error=%s", file.Path().c_str(), file.lastStrError().c_str());
+        return false;
+    }
+
+    struct stat st = {};
+    if (fstat(file.FD(), &st) != 0 || uint64_t(st.st_size) <= base_segment.offset)
+    {
+        KITTY_LOGD("ElfScanner: Couldn't stat %s.", file.Path().c_str());
+        return false;
+    }
+
+    // ELF starts at the map offset, non zero for libs stored uncompressed in an APK
+    const size_t size = size_t(st.st_size - base_segment.offset);
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.FD(), off_t(base_segment.offset));
+    if (data == MAP_FAILED)
+    {
+        KITTY_LOGD("ElfScanner: Couldn't map %s, error=%s", file.Path().c_str(), strerror(errno));
+        return false;
+    }
+
+    auto index = std::make_shared<symbol_index_t>();
+    bool parsed = parseFileSymbols((const char *)data, size, index.get());
+    munmap(data, size);
+
+    if (!parsed)
+        return false;
+
+    _fileSymbolIndex = std::move(index);
+    _symbols_init = false;
+    _symbols.clear();
+    return true;
+}
+
+bool ElfScanner::parseFileSymbols(const char *data, size_t size, symbol_index_t *index) const
+{
+    // program headers are compared too so a replaced file is not mistaken for the loaded one
+    if (size < sizeof(_ehdr) || memcmp(data, &_ehdr, sizeof(_ehdr)) != 0 ||
+        _ehdr.e_phoff + _phdrs.size() * _ehdr.e_phentsize > size)
+    {
+        KITTY_LOGD("ElfScanner: backing file of ELF (%p) doesn't match the loaded image.", (void *)_elfBase);
+        return false;
+    }
+
+    for (size_t i = 0; i < _phdrs.size(); i++)
+    {
+        if (memcmp(data + _ehdr.e_phoff + i * _ehdr.e_phentsize, &_phdrs[i], sizeof(ElfW_(Phdr))) != 0)
+        {
+            KITTY_LOGD("ElfScanner: backing file of ELF (%p) doesn't match the loaded image.", (void *)_elfBase);
+            return false;
+        }
+    }
+
+    if (!_ehdr.e_shoff || _ehdr.e_shentsize < sizeof(ElfW_(Shdr)) ||
+        _ehdr.e_shoff + size_t(_ehdr.e_shnum) * _ehdr.e_shentsize > size)
+    {
+        KITTY_LOGD("ElfScanner: backing file of ELF (%p) has no section headers.", (void *)_elfBase);
+        return false;
+    }
+
+    auto section = [&](size_t i)
+    {
+        ElfW_(Shdr) shdr = {};
+        memcpy(&shdr, data + _ehdr.e_shoff + i * _ehdr.e_shentsize, sizeof(shdr));
+        return shdr;
+    };
+
+    auto in_file = [size](const ElfW_(Shdr) &shdr)
+    { return shdr.sh_type != SHT_NOBITS && shdr.sh_offset <= size && shdr.sh_size <= size - shdr.sh_offset; };
+
+    ElfW_(Shdr) symtab = {}, strtab = {};
+    bool found = false, debugdata = false;
+
+    ElfW_(Shdr) shstrtab = _ehdr.e_shstrndx < _ehdr.e_shnum ? section(_ehdr.e_shstrndx) : ElfW_(Shdr){};
+    for (size_t i = 0; i < _ehdr.e_shnum; i++)
+    {
+        ElfW_(Shdr) shdr = section(i);
+        if (shdr.sh_type == SHT_SYMTAB && shdr.sh_link < _ehdr.e_shnum)
+        {
+            symtab = shdr;
+            strtab = section(shdr.sh_link);
+            found = true;
+        }
+        else if (shdr.sh_type == SHT_PROGBITS && in_file(shstrtab) && shdr.sh_name < shstrtab.sh_size &&
+                 strncmp(data + shstrtab.sh_offset + shdr.sh_name, ".gnu_debugdata",
+                         shstrtab.sh_size - shdr.sh_name) == 0)
+        {
+            debugdata = true;
+        }
+    }
+
+    if (!found)
+    {
+        if (debugdata)
+            KITTY_LOGD("ElfScanner: ELF (%p) only has .gnu_debugdata symbols, LZMA is not supported.", (void *)_elfBase);
+        else
+            KITTY_LOGD("ElfScanner: backing file of ELF (%p) is stripped.", (void *)_elfBase);
+        return false;
+    }
+
+    const size_t entsize = symtab.sh_entsize ? symtab.sh_entsize : sizeof(ElfW_(Sym));
+    if (!in_file(symtab) || !in_file(strtab) || entsize < sizeof(ElfW_(Sym)))
+    {
+        KITTY_LOGD("ElfScanner: invalid .symtab in backing file of ELF (%p).", (void *)_elfBase);
+        return false;
+    }
+
+    index->strtab.assign(data + strtab.sh_offset, data + strtab.sh_offset + strtab.sh_size);
+    const char *names = index->strtab.data();
+    const size_t names_size = index->strtab.size();
+
+    const size_t sym_count = symtab.sh_size / entsize;
+    index->entries.reserve(sym_count);
+    index->names.reserve(sym_count);
+
+    for (size_t i = 0; i < sym_count; i++)
+    {
+        ElfW_(Sym) sym = {};
+        memcpy(&sym, data + symtab.sh_offset + i * entsize, sizeof(sym));
+
+        const int type = ELFW_(ST_TYPE)(sym.st_info);
+        if (!sym.st_name || sym.st_name >= names_size || !sym.st_value || sym.st_shndx == SHN_UNDEF ||
+            sym.st_shndx == SHN_ABS || type == STT_SECTION || type == STT_FILE || type == STT_TLS)
+            continue;
+
+        std::string_view name(names + sym.st_name, strnlen(names + sym.st_name, names_size - sym.st_name));
+        if (name.empty())
+            continue;
+
+        uintptr_t address = _loadBias + sym.st_value;
+        index->entries.emplace_back(address, name);
+        index->names.emplace(name, address);
+    }
+
+    return !index->entries.empty();
+}
 
-        std::vector<char> symbol_table_buff(_stringTable - _symbolTable, 0);
-        std::vector<char> string_table_buff(_strsz, 0);
+bool ElfScanner::initHashTables()
+{
+    if (_hashes_init)
+        return !_gnuBuckets.empty() || !_sysvBuckets.empty();
 
-        if (_pMem->Read(_symbolTable, symbol_table_buff.data(), symbol_table_buff.size()) &&
-        _pMem->Read(_stringTable, string_table_buff.data(), string_table_buff.size()))
+    _hashes_init = true;
+
+    if (_gnuHash)
+    {
+        // nbuckets, symoffset, bloom_size, bloom_shift
+        uint32_t header[4] = {0};
+        if (_pMem->Read(_gnuHash, header, sizeof(header)) == sizeof(header) && header[0] && header[2])
         {
-            uintptr_t sym_start = uintptr_t(symbol_table_buff.data());
-            uintptr_t sym_end = uintptr_t(symbol_table_buff.data()+symbol_table_buff.size());
-            uintptr_t sym_str_end = uintptr_t(string_table_buff.data()+string_table_buff.size());
-            for (auto sym_entry = sym_start; (sym_entry+_syment) < sym_end; sym_entry += _syment)
+            _gnuSymOffset = header[1];
+            _gnuBloomShift = header[3];
+            _gnuBloom.resize(header[2]);
+            _gnuBuckets.resize(header[0]);
+
+            mem_request_t requests[2] = {
+                {_gnuHash + sizeof(header), _gnuBloom.data(), _gnuBloom.size() * sizeof(ElfW_(Addr))},
+                {_gnuHash + sizeof(header) + _gnuBloom.size() * sizeof(ElfW_(Addr)), _gnuBuckets.data(), _gnuBuckets.size() * sizeof(uint32_t)}};
+
+            _pMem->ReadBatch(requests, 2);
+            if (requests[0].result != requests[0].len || requests[1].result != requests[1].len)
             {
-                auto curr_sym = reinterpret_cast<ElfW_(Sym)*>(sym_entry);
-                if (curr_sym->st_name >= _strsz)
-                    break;
+                KITTY_LOGD("ElfScanner: failed to read DT_GNU_HASH of ELF (%p).", (void *)_elfBase);
+                _gnuBloom.clear();
+                _gnuBuckets.clear();
+            }
+        }
+    }
+
+    if (_sysvHash && _gnuBuckets.empty())
+    {
+        // nbucket, nchain
+        uint32_t header[2] = {0};
+        if (_pMem->Read(_sysvHash, header, sizeof(header)) == sizeof(header) && header[0])
+        {
+            _sysvNChain = header[1];
+            _sysvBuckets.resize(header[0]);
+            size_t len = _sysvBuckets.size() * sizeof(uint32_t);
+            if (_pMem->Read(_sysvHash + sizeof(header), _sysvBuckets.data(), len) != len)
+            {
+                KITTY_LOGD("ElfScanner: failed to read DT_HASH of ELF (%p).", (void *)_elfBase);
+                _sysvBuckets.clear();
+            }
+        }
+    }
+
+    return !_gnuBuckets.empty() || !_sysvBuckets.empty();
+}
+
+size_t ElfScanner::countSymbols()
+{
+    if (!isValid())
+        return 0;
+
+    initHashTables();
+
+    if (!_gnuBuckets.empty())
+    {
+        // symbols below symoffset are not hashed, the highest chain ends at the last symbol
+        const uint32_t last_bucket = *std::max_element(_gnuBuckets.begin(), _gnuBuckets.end());
+        if (last_bucket < _gnuSymOffset)
+            return _gnuSymOffset;
 
-                if (intptr_t(curr_sym->st_name) <= 0 || intptr_t(curr_sym->st_value) <= 0)
-                    continue;
+        const uintptr_t chain = _gnuHash + sizeof(uint32_t) * 4 + _gnuBloom.size() * sizeof(ElfW_(Addr)) + _gnuBuckets.size() * sizeof(uint32_t);
 
-                uintptr_t sym_str_addr = uintptr_t(string_table_buff.data() + curr_sym->st_name);
-                if (!sym_str_addr || sym_str_addr >= sym_str_end)
-                    continue;
+        uint32_t hashes[64];
+        for (size_t index = last_bucket;;)
+        {
+            size_t n = _pMem->Read(chain + (index - _gnuSymOffset) * sizeof(uint32_t), hashes, sizeof(hashes)) / sizeof(uint32_t);
+            if (!n)
+                break;
 
-                std::string sym_str = std::string(reinterpret_cast<const char*>(sym_str_addr));
-                if (!sym_str.empty())
-                    _symbols.emplace_back(get_sym_address(curr_sym), sym_str);
+            for (size_t i = 0; i < n; i++, index++)
+            {
+                if (hashes[i] & 1)
+                    return index + 1;
             }
         }
+
+        KITTY_LOGD("ElfScanner: failed to walk DT_GNU_HASH chain of ELF (%p).", (void *)_elfBase);
     }
 
-    return _symbols;
+    if (_sysvNChain)
+        return _sysvNChain;
+
+    // no hash tables, assume the usual symtab then strtab layout
+    if (_stringTable > _symbolTable)
+        return (_stringTable - _symbolTable) / _syment;
+
+    return 0;
 }
 
-uintptr_t ElfScanner::findSymbol(const std::string &symbolName)
+bool ElfScanner::matchSymbol(uint32_t index, std::string_view name, uintptr_t *address) const
 {
-    for (const auto &sym : symbols())
-        if (!sym.second.empty() && sym.second == symbolName)
-            return sym.first;
+    ElfW_(Sym) sym = {};
+    if (_pMem->Read(_symbolTable + index * _syment, &sym, sizeof(sym)) != sizeof(sym))
+        return false;
+
+    // same filter as symbols()
+    if (intptr_t(sym.st_name) <= 0 || intptr_t(sym.st_value) <= 0 || sym.st_name + name.size() >= _strsz)
+        return false;
+
+    std::vector<char> sym_name(name.size() + 1, 0);
+    if (_pMem->Read(_stringTable + sym.st_name, sym_name.data(), sym_name.size()) != sym_name.size())
+        return false;
+
+    if (sym_name.back() != '\0' || memcmp(sym_name.data(), name.data(), name.size()) != 0)
+        return false;
+
+    *address = sym.st_value < _loadBias ? _loadBias + sym.st_value : sym.st_value;
+    return true;
+}
+
+uintptr_t ElfScanner::findSymbolGnu(std::string_view name) const
+{
+    uint32_t hash = 5381;
+    for (unsigned char c : name)
+        hash = hash * 33 + c;
+
+    const uint32_t word_bits = sizeof(ElfW_(Addr)) * 8;
+    const ElfW_(Addr) word = _gnuBloom[(hash / word_bits) % _gnuBloom.size()];
+    const ElfW_(Addr) mask = (ElfW_(Addr)(1) << (hash % word_bits)) | (ElfW_(Addr)(1) << ((hash >> _gnuBloomShift) % word_bits));
+    if ((word & mask) != mask)
+        return 0;
+
+    uint32_t index = _gnuBuckets[hash % _gnuBuckets.size()];
+    if (index < _gnuSymOffset)
+        return 0;
+
+    const uintptr_t chain = _gnuHash + sizeof(uint32_t) * 4 + _gnuBloom.size() * sizeof(ElfW_(Addr)) + _gnuBuckets.size() * sizeof(uint32_t);
+
+    // chains are short, read a few hashes at a time until the end marker
+    uint32_t hashes[16];
+    for (;;)
+    {
+        size_t n = _pMem->Read(chain + (index - _gnuSymOffset) * sizeof(uint32_t), hashes, sizeof(hashes)) / sizeof(uint32_t);
+        if (!n)
+            return 0;
+
+        for (size_t i = 0; i < n; i++, index++)
+        {
+            uintptr_t address = 0;
+            if ((hashes[i] | 1) == (hash | 1) && matchSymbol(index, name, &address))
+                return address;
+
+            if (hashes[i] & 1)
+                return 0;
+        }
+    }
+}
+
+uintptr_t ElfScanner::findSymbolSysv(std::string_view name) const
+{
+    uint32_t hash = 0;
+    for (unsigned char c : name)
+    {
+        hash = (hash << 4) + c;
+        uint32_t g = hash & 0xf0000000;
+        if (g)
+            hash ^= g >> 24;
+        hash &= ~g;
+    }
+
+    const uintptr_t chain = _sysvHash + sizeof(uint32_t) * (2 + _sysvBuckets.size());
+
+    uint32_t index = _sysvBuckets[hash % _sysvBuckets.size()];
+    for (size_t steps = 0; index && steps < 0x100000; steps++)
+    {
+        uintptr_t address = 0;
+        if (matchSymbol(index, name, &address))
+            return address;
+
+        if (_pMem->Read(chain + index * sizeof(uint32_t), &index, sizeof(index)) != sizeof(index))
+            return 0;
+    }
 
     return 0;
+}
+
+uintptr_t ElfScanner::findSymbol(const std::string &symbolName)
+{
+    std::string_view name(symbolName);
+    return findSymbols(&name, 1).front();
+}
+
+std::vector<uintptr_t> ElfScanner::findSymbols(const std::string_view *symbolNames, size_t count)
+{
+    // below this many names hash table lookups read less than the whole symbol table
+    static const size_t kIndexMinBatch = 64;
+
+    std::vector<uintptr_t> addresses(count, 0);
+    if (!symbolNames || !count || !isValid())
+        return addresses;
+
+    if (!_symbolIndex && count < kIndexMinBatch && initHashTables())
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!symbolNames[i].empty())
+                addresses[i] = !_gnuBuckets.empty() ? findSymbolGnu(symbolNames[i]) : findSymbolSysv(symbolNames[i]);
+        }
+    }
+    else if (loadSymbolIndex())
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            auto it = _symbolIndex->names.find(symbolNames[i]);
+            if (it != _symbolIndex->names.end())
+                addresses[i] = it->second;
+        }
+    }
+
+    if (_fileSymbolIndex)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (addresses[i])
+                continue;
+
+            auto it = _fileSymbolIndex->names.find(symbolNames[i]);
+            if (it != _fileSymbolIndex->names.end())
+                addresses[i] = it->second;
+        }
+    }
+
+    return addresses;
+}
+
+std::vector<uintptr_t> ElfScanner::findSymbols(const std::vector<std::string> &symbolNames)
+{
+    std::vector<std::string_view> names(symbolNames.begin(), symbolNames.end());
+    return findSymbols(names.data(), names.size());
+}
+
+std::vector<elf_relocation_t> ElfScanner::relocations(bool includeRelative)
+{
+    std::vector<elf_relocation_t> relocs;
+    if (!isValid())
+        return relocs;
+
+    uintptr_t jmprel = 0, rela = 0, rel = 0, relr = 0;
+    size_t pltrelsz = 0, relasz = 0, relsz = 0, relrsz = 0;
+    size_t relaent = sizeof(ElfW_(Rela)), relent = sizeof(ElfW_(Rel)), relrent = sizeof(ElfW_(Addr));
+    bool pltIsRela = sizeof(void *) == 8;
+
+    for (auto &dyn : _dynamics)
+    {
+        switch (dyn.d_tag)
+        {
+        case DT_JMPREL:
+            jmprel = dyn.d_un.d_ptr;
+            break;
+        case DT_PLTRELSZ:
+            pltrelsz = dyn.d_un.d_val;
+            break;
+        case DT_PLTREL:
+            pltIsRela = dyn.d_un.d_val == DT_RELA;
+            break;
+        case DT_RELA:
+            rela = dyn.d_un.d_ptr;
+            break;
+        case DT_RELASZ:
+            relasz = dyn.d_un.d_val;
+            break;
+        case DT_RELAENT:
+            relaent = dyn.d_un.d_val;
+            break;
+        case DT_REL:
+            rel = dyn.d_un.d_ptr;
+            break;
+        case DT_RELSZ:
+            relsz = dyn.d_un.d_val;
+            break;
+        case DT_RELENT:
+            relent = dyn.d_un.d_val;
+            break;
+        case DT_RELR:
+            relr = dyn.d_un.d_ptr;
+            break;
+        case DT_RELRSZ:
+            relrsz = dyn.d_un.d_val;
+            break;
+        case DT_RELRENT:
+            relrent = dyn.d_un.d_val;
+            break;
+        case DT_ANDROID_REL:
+        case DT_ANDROID_RELA:
+            KITTY_LOGD("ElfScanner: packed relocations of ELF (%p) are not supported.", (void *)_elfBase);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (relaent < sizeof(ElfW_(Rela)) || relent < sizeof(ElfW_(Rel)) || relrent != sizeof(ElfW_(Addr)))
+    {
+        KITTY_LOGD("ElfScanner: unexpected relocation entry size in ELF (%p).", (void *)_elfBase);
+        return relocs;
+    }
+
+    for (uintptr_t *table : {&jmprel, &rela, &rel, &relr})
+    {
+        if (*table && *table < _loadBias)
+            *table += _loadBias;
+    }
+
+    if (!includeRelative)
+        relrsz = 0;
+
+    // read all tables at once
+    std::vector<char> jmprel_buf(jmprel ? pltrelsz : 0), rela_buf(rela ? relasz : 0);
+    std::vector<char> rel_buf(rel ? relsz : 0), relr_buf(relr ? relrsz : 0);
+
+    std::vector<mem_request_t> requests;
+    for (auto &it : {std::make_pair(jmprel, &jmprel_buf), std::make_pair(rela, &rela_buf),
+                     std::make_pair(rel, &rel_buf), std::make_pair(relr, &relr_buf)})
+    {
+        if (!it.second->empty())
+            requests.emplace_back(it.first, it.second->data(), it.second->size());
+    }
+
+    if (requests.empty())
+        return relocs;
+
+    _pMem->ReadBatch(requests);
+    for (auto &it : requests)
+    {
+        if (it.result != it.len)
+        {
+            KITTY_LOGD("ElfScanner: failed to read relocations of ELF (%p).", (void *)_elfBase);
+            return relocs;
+        }
+    }
+
+    std::vector<uint32_t> sym_indices;
+
+    auto add = [&](uintptr_t offset, uintptr_t info, bool plt)
+    {
+        const uint32_t sym = uint32_t(ELFW_(R_SYM)(info)), type = uint32_t(ELFW_(R_TYPE)(info));
+        if (!type || (!sym && !includeRelative))
+            return;
+
+        elf_relocation_t reloc;
+        reloc.slot = _loadBias + offset;
+        reloc.type = type;
+        reloc.plt = plt;
+        relocs.push_back(reloc);
+        sym_indices.push_back(sym);
+    };
+
+    // some linkers include DT_JMPREL in DT_RELASZ / DT_RELSZ, skip those entries the second time
+    auto in_jmprel = [&](uintptr_t entry)
+    { return jmprel_buf.size() && entry >= jmprel && entry < jmprel + jmprel_buf.size(); };
+
+    if (pltIsRela)
+    {
+        for (size_t i = 0; (i + 1) * relaent <= jmprel_buf.size(); i++)
+        {
+            ElfW_(Rela) r = {};
+            memcpy(&r, jmprel_buf.data() + i * relaent, sizeof(r));
+            add(r.r_offset, r.r_info, true);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; (i + 1) * relent <= jmprel_buf.size(); i++)
+        {
+            ElfW_(Rel) r = {};
+            memcpy(&r, jmprel_buf.data() + i * relent, sizeof(r));
+            add(r.r_offset, r.r_info, true);
+        }
+    }
+
+    for (size_t i = 0; (i + 1) * relaent <= rela_buf.size(); i++)
+    {
+        if (in_jmprel(rela + i * relaent))
+            continue;
+
+        ElfW_(Rela) r = {};
+        memcpy(&r, rela_buf.data() + i * relaent, sizeof(r));
+        add(r.r_offset, r.r_info, false);
+    }
+
+    for (size_t i = 0; (i + 1) * relent <= rel_buf.size(); i++)
+    {
+        if (in_jmprel(rel + i * relent))
+            continue;
+
+        ElfW_(Rel) r = {};
+        memcpy(&r, rel_buf.data() + i * relent, sizeof(r));
+        add(r.r_offset, r.r_info, false);
+    }
+
+    // even entries are addresses, odd ones are bitmaps of the words following the last address
+    uintptr_t where = 0;
+    const size_t word_bits = sizeof(ElfW_(Addr)) * 8;
+    for (size_t i = 0; (i + 1) * relrent <= relr_buf.size(); i++)
+    {
+        ElfW_(Addr) entry = 0;
+        memcpy(&entry, relr_buf.data() + i * relrent, sizeof(entry));
+
+        if (!(entry & 1))
+        {
+            where = _loadBias + entry;
+            relocs.emplace_back();
+            relocs.back().slot = where;
+            sym_indices.push_back(0);
+            where += sizeof(ElfW_(Addr));
+            continue;
+        }
+
+        for (size_t bit = 1; bit < word_bits; bit++)
+        {
+            if ((entry >> bit) & 1)
+            {
+                relocs.emplace_back();
+                relocs.back().slot = where + (bit - 1) * sizeof(ElfW_(Addr));
+                sym_indices.push_back(0);
+            }
+        }
+        where += (word_bits - 1) * sizeof(ElfW_(Addr));
+    }
+
+    if (relocs.empty())
+        return relocs;
+
+    // referenced symbols and the string table in one batch
+    const uint32_t max_sym = *std::max_element(sym_indices.begin(), sym_indices.end());
+    std::vector<char> syms_buf(max_sym ? (size_t(max_sym) + 1) * _syment : 0), strtab(max_sym ? _strsz : 0);
+    if (max_sym)
+    {
+        mem_request_t sym_requests[2] = {
+            {_symbolTable, syms_buf.data(), syms_buf.size()},
+            {_stringTable, strtab.data(), strtab.size()}};
+
+        _pMem->ReadBatch(sym_requests, 2);
+        if (sym_requests[0].result != sym_requests[0].len || sym_requests[1].result != sym_requests[1].len)
+        {
+            KITTY_LOGD("ElfScanner: failed to read relocation symbols of ELF (%p).", (void *)_elfBase);
+            syms_buf.clear();
+        }
+    }
+
+    for (size_t i = 0; i < relocs.size(); i++)
+    {
+        const size_t sym_index = sym_indices[i];
+        if (!sym_index || (sym_index + 1) * _syment > syms_buf.size())
+            continue;
+
+        ElfW_(Sym) sym = {};
+        memcpy(&sym, syms_buf.data() + sym_index * _syment, std::min(sizeof(sym), _syment));
+        if (sym.st_name < strtab.size())
+            relocs[i].symbol.assign(strtab.data() + sym.st_name, strnlen(strtab.data() + sym.st_name, strtab.size() - sym.st_name));
+
+        relocs[i].imported = sym.st_shndx == SHN_UNDEF;
+    }
+
+    // current slot values in one batch
+    std::vector<mem_request_t> slot_requests;
+    slot_requests.reserve(relocs.size());
+    for (auto &it : relocs)
+        slot_requests.emplace_back(it.slot, &it.target, sizeof(it.target));
+
+    _pMem->ReadBatch(slot_requests);
+
+    return relocs;
+}
+
+std::vector<elf_relocation_t> ElfScanner::imports()
+{
+    std::vector<elf_relocation_t> ret;
+    for (auto &it : relocations(false))
+    {
+        if (it.imported && !it.symbol.empty())
+            ret.push_back(std::move(it));
+    }
+    return ret;
 }
\ No newline at end of file
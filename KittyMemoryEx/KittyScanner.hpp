@@ -3,15 +3,308 @@
 #include "KittyUtils.hpp"
 #include "KittyMemoryEx.hpp"
 #include "KittyMemOp.hpp"
+#include "KittyPageMap.hpp"
+
+#include <bitset>
+#include <unordered_map>
+#include <string_view>
+
+// scanners stream memory through a buffer of this size instead of reading whole ranges
+#ifndef KT_SCAN_CHUNK_SIZE
+#define KT_SCAN_CHUNK_SIZE (2 * 1024 * 1024)
+#endif
+
+// without SIMD, exact patterns at least this long are searched with Horspool
+#ifndef KT_SCAN_HORSPOOL_MIN
+#define KT_SCAN_HORSPOOL_MIN 32
+#endif
+
+/**
+ * Pattern bytes and mask compiled once along with the anchors scanners use to find candidates
+ * literal ida patterns can be compiled at build time with KT_IDA_PATTERN("AA ? BB")
+ */
+class KittyPattern
+{
+public:
+    /**
+     * Build time compiled pattern, see compileIda
+     */
+    template <size_t N>
+    struct literal_t
+    {
+        uint8_t bytes[N];
+        uint8_t mask[N];
+        size_t size, solid, anchor1, anchor2;
+    };
+
+    // rough rarity of a byte in code and data, lower is rarer
+    static constexpr int byteScore(uint8_t b)
+    {
+        switch (b)
+        {
+        case 0x00:
+            return 255;
+        case 0xFF:
+            return 200;
+        case 0x01: case 0x02: case 0x03: case 0x04: case 0x08: case 0x10:
+        case 0x20: case 0x40: case 0x80: case 0xE0: case 0xF0: case 0xFE:
+            return 120;
+        // common x86 & arm opcode and register bytes
+        case 0x0F: case 0x24: case 0x48: case 0x89: case 0x8B: case 0x83: case 0xE8:
+        case 0xC3: case 0xCC: case 0x90: case 0x4C: case 0x85: case 0x74: case 0x75:
+        case 0xA9: case 0xF9: case 0x91: case 0xD1: case 0x52: case 0xB9: case 0x94:
+        case 0x97: case 0xD6: case 0x5F: case 0x3E:
+            return 80;
+        default:
+            return b < 0x20 ? 40 : 10;
+        }
+    }
+
+    /**
+     * Parse ida pattern, each ? is one wildcard byte and anything besides hex pairs is skipped
+     *
+     * @param bytes: output bytes, wildcards are 0
+     * @param mask: output mask, 0xFF compare and 0x00 wildcard
+     * @param max: size of bytes and mask
+     *
+     * @return number of bytes, 0 if pattern is empty or longer than max
+     */
+    static constexpr size_t parseIda(const char *pattern, size_t len, uint8_t *bytes, uint8_t *mask, size_t max)
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            if (pattern[i] == '?')
+            {
+                if (n >= max)
+                    return 0;
+                bytes[n] = 0, mask[n++] = 0x00;
+            }
+            else if (i + 1 < len && hexValue(pattern[i]) >= 0 && hexValue(pattern[i + 1]) >= 0)
+            {
+                if (n >= max)
+                    return 0;
+                bytes[n] = uint8_t((hexValue(pattern[i]) << 4) | hexValue(pattern[i + 1]));
+                mask[n++] = 0xFF;
+                i++;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * Pick the two rarest fixed bytes as anchors, both are the same if only one byte is fixed
+     *
+     * @return number of fixed bytes
+     */
+    static constexpr size_t selectAnchors(const uint8_t *bytes, const uint8_t *mask, size_t size, size_t *anchor1, size_t *anchor2)
+    {
+        size_t solid = 0;
+        size_t a1 = 0, a2 = 0;
+        int best1 = 0x7fffffff, best2 = 0x7fffffff;
+        for (size_t i = 0; i < size; i++)
+        {
+            if (!mask[i])
+                continue;
+
+            solid++;
+            int score = byteScore(bytes[i]);
+            if (score < best1)
+            {
+                best2 = best1, a2 = a1;
+                best1 = score, a1 = i;
+            }
+            else if (score < best2 || (score == best2 && i > a2))
+            {
+                // on ties prefer the one further from first anchor
+                best2 = score, a2 = i;
+            }
+        }
+
+        *anchor1 = a1;
+        *anchor2 = solid < 2 ? a1 : a2;
+        return solid;
+    }
+
+    /**
+     * Compile an ida pattern literal, use in constant expressions
+     * size is 0 if pattern is invalid
+     * each ? is its own wildcard byte so a pattern has at most one byte per character
+     */
+    template <size_t L>
+    static constexpr literal_t<L> compileIda(const char (&pattern)[L])
+    {
+        literal_t<L> lit{};
+        lit.size = parseIda(pattern, L - 1, lit.bytes, lit.mask, L);
+        lit.solid = selectAnchors(lit.bytes, lit.mask, lit.size, &lit.anchor1, &lit.anchor2);
+        return lit;
+    }
+
+private:
+    std::vector<uint8_t> _bytes;
+    std::vector<uint8_t> _mask;
+    size_t _solid, _anchor1, _anchor2;
+    // Horspool bad character shifts capped at 255, only for long exact patterns
+    std::vector<uint8_t> _skip;
+
+    static constexpr int hexValue(char c)
+    {
+        return (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+    }
+
+    void compile();
+    void buildSkipTable();
+
+public:
+    KittyPattern() : _solid(0), _anchor1(0), _anchor2(0) {}
+
+    /**
+     * @param bytes: pattern bytes
+     * @param mask: bytes mask x/?
+     */
+    KittyPattern(const char *bytes, const std::string &mask);
+
+    /**
+     * Exact data pattern, no wildcards
+     */
+    KittyPattern(const void *data, size_t size);
+
+    template <size_t N>
+    KittyPattern(const literal_t<N> &lit)
+        : _bytes(lit.bytes, lit.bytes + lit.size), _mask(lit.mask, lit.mask + lit.size),
+          _solid(lit.solid), _anchor1(lit.anchor1), _anchor2(lit.anchor2) { buildSkipTable(); }
+
+    /**
+     * @param pattern: ida pattern, ? for wildcards
+     */
+    static KittyPattern fromIda(const std::string &pattern);
+
+    /**
+     * @param hex: hex bytes
+     * @param mask: hex mask x/?, one per byte
+     */
+    static KittyPattern fromHex(std::string hex, const std::string &mask);
+
+    inline bool isValid() const { return !_bytes.empty(); }
+
+    inline size_t size() const { return _bytes.size(); }
+    inline const std::vector<uint8_t> &bytes() const { return _bytes; }
+    // 0xFF compare, 0x00 wildcard
+    inline const std::vector<uint8_t> &mask() const { return _mask; }
+
+    // number of non wildcard bytes
+    inline size_t solid() const { return _solid; }
+    inline bool isExact() const { return !_bytes.empty() && _solid == _bytes.size(); }
+
+    // rarest non wildcard bytes offsets
+    inline size_t anchor1() const { return _anchor1; }
+    inline size_t anchor2() const { return _anchor2; }
+    inline uint8_t anchor1Byte() const { return _bytes.empty() ? 0 : _bytes[_anchor1]; }
+    inline uint8_t anchor2Byte() const { return _bytes.empty() ? 0 : _bytes[_anchor2]; }
+
+    // 256 Horspool shifts by last window byte if pattern is exact and long enough, else nullptr
+    inline const uint8_t *skipTable() const { return _skip.empty() ? nullptr : _skip.data(); }
+
+    // x/? mask string
+    std::string maskString() const;
+};
+
+// KittyPattern from an ida pattern literal parsed and checked at build time
+#define KT_IDA_PATTERN(pattern)                                                     \
+    ([]() {                                                                         \
+        constexpr auto kt_ida_literal = KittyPattern::compileIda(pattern);         \
+        static_assert(kt_ida_literal.size > 0, "KT_IDA_PATTERN: invalid pattern"); \
+        return KittyPattern(kt_ida_literal);                                       \
+    }())
+
+/**
+ * Named ida patterns searched together in a single pass over memory
+ * patterns are bucketed by their rarest run of four or two adjacent fixed bytes
+ */
+class PatternSet
+{
+    friend class KittyScannerMgr;
+
+private:
+    struct entry_t
+    {
+        std::string name;
+        std::vector<uint8_t> bytes;
+        std::vector<uint8_t> mask; // 0xFF compare, 0x00 wildcard
+        size_t anchor = 0;         // offset of anchor byte(s)
+        uint32_t next = UINT32_MAX; // next pattern in the same anchor bucket
+    };
+
+    std::vector<entry_t> _patterns;
+    std::unordered_map<std::string, size_t> _names;
+    size_t _maxSize;
+
+    // bucket heads of patterns anchored at four adjacent bytes, by hash of little endian quad
+    std::vector<uint32_t> _quads;
+    // bucket heads of patterns anchored at two adjacent bytes, by little endian pair
+    std::vector<uint32_t> _pairs;
+    // small filters of non empty buckets to keep the scan loop in cache
+    std::bitset<0x10000> _quadFilter, _pairFilter;
+    // bucket heads of patterns without adjacent fixed bytes, by anchor byte
+    std::vector<uint32_t> _singles;
+    // wildcard only patterns
+    std::vector<uint32_t> _unanchored;
+
+    static inline uint32_t quadHash(uint32_t quad) { return (quad * 2654435761u) >> 16; }
+
+public:
+    PatternSet() : _maxSize(0), _quads(0x10000, UINT32_MAX), _pairs(0x10000, UINT32_MAX), _singles(0x100, UINT32_MAX) {}
+
+    /**
+     * Add a named pattern, fails if pattern is invalid or name already exists
+     *
+     * @param name: pattern name, key in results
+     * @param pattern: ida pattern
+     */
+    bool add(const std::string &name, const std::string &pattern);
+
+    /**
+     * Add a named pattern, fails if pattern is invalid or name already exists
+     *
+     * @param name: pattern name, key in results
+     * @param bytes: pattern bytes
+     * @param mask: bytes mask x/?
+     */
+    bool add(const std::string &name, const char *bytes, const std::string &mask);
+
+    /**
+     * Add a named compiled pattern, fails if pattern is invalid or name already exists
+     */
+    bool add(const std::string &name, const KittyPattern &pattern);
+
+    inline size_t size() const { return _patterns.size(); }
+    inline bool empty() const { return _patterns.empty(); }
+    inline size_t maxPatternSize() const { return _maxSize; }
+
+    void clear();
+};
 
 class KittyScannerMgr
 {
 private:
     IKittyMemOp *_pMem;
+    const KittyPageMap *_pPageMap;
+
+    // one streamed pass over [start, end) for all patterns of set, results indexed like set patterns
+    bool scanPatternSet(const uintptr_t start, const uintptr_t end, const PatternSet &set,
+                        bool firstOnly, std::vector<std::vector<uintptr_t>> *out) const;
 
 public:
-    KittyScannerMgr() : _pMem(nullptr) {}
-    KittyScannerMgr(IKittyMemOp *pMem) : _pMem(pMem) {}
+    KittyScannerMgr() : _pMem(nullptr), _pPageMap(nullptr) {}
+    KittyScannerMgr(IKittyMemOp *pMem) : _pMem(pMem), _pPageMap(nullptr) {}
+
+    /**
+     * Skip never touched pages of anonymous maps, they are scanned as zeros without faulting them in
+     * file backed maps are always read, their pages may be unfaulted here but still hold file data
+     * nullptr to read everything
+     */
+    inline void setResidentOnly(const KittyPageMap *pageMap) { _pPageMap = pageMap; }
+    inline const KittyPageMap *residentOnly() const { return _pPageMap; }
 
     /**
      * Search for bytes within a memory range and return all results
@@ -37,6 +330,28 @@ public:
      */
     uintptr_t findBytesFirst(const uintptr_t start, const uintptr_t end, const char *bytes, const std::string &mask) const;
 
+    /**
+     * Search for compiled pattern within a memory range and return all results
+     *
+     * @param start: search start address
+     * @param end: search end address
+     * @param pattern: compiled pattern
+     *
+     * @return vector list of all found pattern addresses
+     */
+    std::vector<uintptr_t> findPatternAll(const uintptr_t start, const uintptr_t end, const KittyPattern &pattern) const;
+
+    /**
+     * Search for compiled pattern within a memory range and return first result
+     *
+     * @param start: search start address
+     * @param end: search end address
+     * @param pattern: compiled pattern
+     *
+     * @return first found pattern address
+     */
+    uintptr_t findPatternFirst(const uintptr_t start, const uintptr_t end, const KittyPattern &pattern) const;
+
     /**
      * Search for hex within a memory range and return all results
      *
@@ -83,6 +398,68 @@ public:
      */
     uintptr_t findIdaPatternFirst(const uintptr_t start, const uintptr_t end, const std::string& pattern);
 
+    /**
+     * Search for all patterns of a set within a memory range in a single pass and return all results
+     *
+     * @param start: search start address
+     * @param end: search end address
+     * @param patterns: pattern set
+     *
+     * @return found addresses of each pattern by name
+     */
+    std::unordered_map<std::string, std::vector<uintptr_t>> findPatternSetAll(const uintptr_t start, const uintptr_t end, const PatternSet &patterns) const;
+
+    /**
+     * Search for all patterns of a set within a memory range in a single pass and return first results
+     *
+     * @param start: search start address
+     * @param end: search end address
+     * @param patterns: pattern set
+     *
+     * @return first found address of each pattern by name, 0 if not found
+     */
+    std::unordered_map<std::string, uintptr_t> findPatternSetFirst(const uintptr_t start, const uintptr_t end, const PatternSet &patterns) const;
+
+    /**
+     * Search for ida pattern within all readable regions of the process using multiple threads
+     *
+     * @param pattern: ida pattern, ? for wildcards
+     * @param filter: optional, only regions it returns true for are scanned
+     * @param threads: number of threads, 0 for hardware concurrency
+     *
+     * @return vector list of all found addresses sorted by address
+     */
+    std::vector<uintptr_t> scanProcess(const std::string &pattern,
+                                       const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter = nullptr,
+                                       size_t threads = 0) const;
+
+    /**
+     * Search for bytes within all readable regions of the process using multiple threads
+     *
+     * @param bytes: bytes to search
+     * @param mask: bytes mask x/?
+     * @param filter: optional, only regions it returns true for are scanned
+     * @param threads: number of threads, 0 for hardware concurrency
+     *
+     * @return vector list of all found addresses sorted by address
+     */
+    std::vector<uintptr_t> scanProcess(const char *bytes, const std::string &mask,
+                                       const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter = nullptr,
+                                       size_t threads = 0) const;
+
+    /**
+     * Search for compiled pattern within all readable regions of the process using multiple threads
+     *
+     * @param pattern: compiled pattern
+     * @param filter: optional, only regions it returns true for are scanned
+     * @param threads: number of threads, 0 for hardware concurrency
+     *
+     * @return vector list of all found addresses sorted by address
+     */
+    std::vector<uintptr_t> scanProcess(const KittyPattern &pattern,
+                                       const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter = nullptr,
+                                       size_t threads = 0) const;
+
     /**
      * Search for data within a memory range and return all results
      *
@@ -108,11 +485,59 @@ public:
     uintptr_t findDataFirst(const uintptr_t start, const uintptr_t end, const void *data, size_t size) const;
 };
 
+// missing from older elf.h
+#ifndef DT_RELRSZ
+#define DT_RELRSZ 35
+#define DT_RELR 36
+#define DT_RELRENT 37
+#endif
+
+#ifndef DT_ANDROID_REL
+#define DT_ANDROID_REL 0x6000000f
+#define DT_ANDROID_RELA 0x60000011
+#endif
+
+/**
+ * Relocated pointer of an ELF, for symbol bound ones usually a GOT slot
+ */
+struct elf_relocation_t
+{
+    std::string symbol;     // empty for relative relocations
+    uintptr_t slot = 0;     // absolute address of the relocated pointer
+    uintptr_t target = 0;   // pointer currently stored in slot
+    uint32_t type = 0;      // R_* type, 0 for DT_RELR entries
+    bool plt = false;       // from DT_JMPREL
+    bool imported = false;  // symbol is undefined in this ELF
+};
+
 class ElfScanner
 {
     friend class ElfScannerMgr;
 
 private:
+    // dynamic symbols read at once, names are views into strtab
+    struct symbol_index_t
+    {
+        std::vector<char> strtab;
+        std::vector<std::pair<uintptr_t, std::string_view>> entries; // symbol table order
+        std::unordered_map<std::string_view, uintptr_t> names;      // first entry of each name
+    };
+
+    // reads hash tables headers and buckets once
+    bool initHashTables();
+    // counts dynamic symbols through hash tables
+    size_t countSymbols();
+    // checks dynamic symbol at index, sets address if its name matches
+    bool matchSymbol(uint32_t index, std::string_view name, uintptr_t *address) const;
+    uintptr_t findSymbolGnu(std::string_view name) const;
+    uintptr_t findSymbolSysv(std::string_view name) const;
+    // reads symbol and string tables once and indexes them by name
+    bool loadSymbolIndex();
+    // finds segments and .bss in maps on first use
+    void initSegments() const;
+    // indexes .symtab of a locally mapped copy of this ELF
+    bool parseFileSymbols(const char *data, size_t size, symbol_index_t *index) const;
+
     IKittyMemOp *_pMem;
     uintptr_t _elfBase;
     ElfW_(Ehdr) _ehdr;
@@ -120,21 +545,41 @@ private:
     std::vector<ElfW_(Phdr)> _phdrs;
     int _loads;
     uintptr_t _loadBias, _loadSize;
-    uintptr_t _bss;
-    size_t _bssSize;
+    mutable uintptr_t _bss;
+    mutable size_t _bssSize;
     uintptr_t _dynamic;
     std::vector<ElfW_(Dyn)> _dynamics;
     uintptr_t _stringTable, _symbolTable;
     size_t _strsz, _syment;
     bool _symbols_init;
     std::vector<std::pair<uintptr_t, std::string>> _symbols;
-    KittyMemoryEx::ProcMap _base_segment;
-    std::vector<KittyMemoryEx::ProcMap> _segments;
+    uintptr_t _gnuHash, _sysvHash;
+    bool _hashes_init;
+    uint32_t _gnuSymOffset, _gnuBloomShift, _sysvNChain;
+    std::vector<ElfW_(Addr)> _gnuBloom;
+    std::vector<uint32_t> _gnuBuckets, _sysvBuckets;
+    bool _symbolCount_init;
+    size_t _symbolCount;
+    std::shared_ptr<const symbol_index_t> _symbolIndex; // shared by copies
+    std::shared_ptr<const symbol_index_t> _fileSymbolIndex; // .symtab of backing file
+    mutable std::shared_ptr<const KittyMemoryEx::ProcMapIndex> _maps; // released once segments are found
+    mutable bool _segments_init;
+    mutable KittyMemoryEx::ProcMap _base_segment;
+    mutable std::vector<KittyMemoryEx::ProcMap> _segments;
 
 public:
     ElfScanner() : _pMem(nullptr), _elfBase(0), _phdr(0), _loads(0), _loadBias(0), _loadSize(0), _bss(0), _bssSize(0),
-                   _dynamic(0), _stringTable(0), _symbolTable(0), _strsz(0), _syment(0), _symbols_init(false) {}
-    ElfScanner(IKittyMemOp *pMem, uintptr_t elfBase);
+                   _dynamic(0), _stringTable(0), _symbolTable(0), _strsz(0), _syment(0), _symbols_init(false),
+                   _gnuHash(0), _sysvHash(0), _hashes_init(false), _gnuSymOffset(0), _gnuBloomShift(0),
+                   _sysvNChain(0), _symbolCount_init(false), _symbolCount(0), _segments_init(false) {}
+
+    /**
+     * Parses headers from the first page and the dynamic section
+     * @param maps: optional maps snapshot used to find segments, shared between scanners of the same process,
+     * maps are read on first segments() call when not given
+     */
+    ElfScanner(IKittyMemOp *pMem, uintptr_t elfBase,
+               const std::shared_ptr<const KittyMemoryEx::ProcMapIndex> &maps = nullptr);
 
     inline bool isValid() const
     {
@@ -158,9 +603,19 @@ public:
 
     inline uintptr_t loadSize() const { return _loadSize; }
 
-    inline uintptr_t bss() const { return _bss; }
-    
-    inline size_t bssSize() const { return _bssSize; }
+    inline uintptr_t bss() const
+    {
+        if (!_bss)
+            initSegments();
+        return _bss;
+    }
+
+    inline size_t bssSize() const
+    {
+        if (!_bss)
+            initSegments();
+        return _bssSize;
+    }
 
     inline uintptr_t dynamic() const { return _dynamic; }
 
@@ -174,16 +629,78 @@ public:
 
     inline size_t symbolEntrySize() const { return _syment; }
 
+    inline uintptr_t gnuHashTable() const { return _gnuHash; }
+
+    inline uintptr_t hashTable() const { return _sysvHash; }
+
+    /**
+     * Number of dynamic symbol table entries, from DT_HASH nchain or a DT_GNU_HASH chain walk
+     * without hash tables the string table is assumed to follow the symbol table, 0 if unknown
+     */
+    inline size_t symbolCount()
+    {
+        if (!_symbolCount_init)
+        {
+            _symbolCount_init = true;
+            _symbolCount = countSymbols();
+        }
+        return _symbolCount;
+    }
+
     std::vector<std::pair<uintptr_t, std::string>> symbols();
 
     // retuns the absolute address of symbol in dynstr
+    // looks up DT_GNU_HASH or DT_HASH when present, reading only the needed entries
     uintptr_t findSymbol(const std::string &symbolName);
 
-    inline KittyMemoryEx::ProcMap baseSegment() const { return _base_segment; }
+    /**
+     * Absolute address of each symbol, 0 if not found
+     * large batches read the symbol table once and resolve through a name index
+     */
+    std::vector<uintptr_t> findSymbols(const std::string_view *symbolNames, size_t count);
+    std::vector<uintptr_t> findSymbols(const std::vector<std::string> &symbolNames);
+
+    /**
+     * Add .symtab symbols of the backing file to symbols() and findSymbol(s), dynamic symbols take precedence
+     * the file is mapped locally, at the map offset for libs stored in an APK,
+     * .gnu_debugdata (LZMA compressed .symtab) is not supported
+     * @return false if the file couldn't be read, doesn't match the loaded ELF or is stripped
+     */
+    bool loadFileSymbols();
 
-    inline std::vector<KittyMemoryEx::ProcMap> segments() const { return _segments; }
+    inline bool hasFileSymbols() const { return _fileSymbolIndex != nullptr; }
 
-    inline std::string filePath() const { return _base_segment.pathname; }
+    /**
+     * Relocations of DT_JMPREL and DT_RELA / DT_REL, and DT_RELR with includeRelative
+     * relocation tables, referenced symbols and slots are each read in one batch
+     * Android packed relocations (DT_ANDROID_REL / DT_ANDROID_RELA) are not supported
+     *
+     * @param includeRelative: also return relocations without symbol, their slots hold pointers into this ELF
+     */
+    std::vector<elf_relocation_t> relocations(bool includeRelative = false);
+
+    /**
+     * Relocations bound to symbols this ELF imports, overwrite slot to redirect an imported function
+     */
+    std::vector<elf_relocation_t> imports();
+
+    inline KittyMemoryEx::ProcMap baseSegment() const
+    {
+        initSegments();
+        return _base_segment;
+    }
+
+    inline std::vector<KittyMemoryEx::ProcMap> segments() const
+    {
+        initSegments();
+        return _segments;
+    }
+
+    inline std::string filePath() const
+    {
+        initSegments();
+        return _base_segment.pathname;
+    }
 };
 
 class ElfScannerMgr
@@ -195,12 +712,14 @@ public:
     ElfScannerMgr() : _pMem(nullptr) {}
     ElfScannerMgr(IKittyMemOp *pMem) : _pMem(pMem) {}
 
-    inline ElfScanner createWithBase(uintptr_t elfBase) const
+    inline ElfScanner createWithBase(uintptr_t elfBase,
+                                     const std::shared_ptr<const KittyMemoryEx::ProcMapIndex> &maps = nullptr) const
     {
-        return !_pMem ? ElfScanner() : ElfScanner(_pMem, elfBase);
+        return !_pMem ? ElfScanner() : ElfScanner(_pMem, elfBase, maps);
     }
-    inline ElfScanner createWithMap(const KittyMemoryEx::ProcMap &map) const
+    inline ElfScanner createWithMap(const KittyMemoryEx::ProcMap &map,
+                                    const std::shared_ptr<const KittyMemoryEx::ProcMapIndex> &maps = nullptr) const
     {
-        return !_pMem ? ElfScanner() : ElfScanner(_pMem, map.startAddress);
+        return !_pMem ? ElfScanner() : ElfScanner(_pMem, map.startAddress, maps);
     }
 };
\ No newline at end of file
@@ -179,18 +179,17 @@ uintptr_t KittyTraceMgr::callFunctionFrom(uintptr_t callerAddress, uintptr_t fun
     for (int i = 0; (i < nargs) && (i < kREG_ARGS_NUM); i++)
         tmp_regs.uregs[i] = va_arg(vl, uintptr_t);
 
-    // push remaining parameters onto stack
+    // push remaining parameters onto stack with a single write
     if (nargs > kREG_ARGS_NUM)
     {
-        tmp_regs.sp -= sizeof(uintptr_t) * (nargs - kREG_ARGS_NUM);
-        uintptr_t stack = tmp_regs.sp;
-        for (int i = kREG_ARGS_NUM; i < nargs; ++i)
-        {
-            uintptr_t arg = va_arg(vl, uintptr_t);
-            if (!_pMemOp->Write(stack, &arg, sizeof(uintptr_t)))
-                return failure_return();
-            stack += sizeof(uintptr_t);
-        }
+        std::vector<uintptr_t> stack_args(nargs - kREG_ARGS_NUM);
+        for (auto &arg : stack_args)
+            arg = va_arg(vl, uintptr_t);
+
+        size_t stack_size = sizeof(uintptr_t) * stack_args.size();
+        tmp_regs.sp -= stack_size;
+        if (_pMemOp->Write(tmp_regs.sp, stack_args.data(), stack_size) != stack_size)
+            return failure_return();
     }
 
     // Set return address
@@ -214,20 +213,15 @@ uintptr_t KittyTraceMgr::callFunctionFrom(uintptr_t callerAddress, uintptr_t fun
 
 #elif defined(__i386__)
 
-    // push all parameters onto stack
-    tmp_regs.esp -= sizeof(uintptr_t) * nargs;
-    uintptr_t stack = tmp_regs.esp;
+    // push return address followed by all parameters onto stack with a single write
+    std::vector<uintptr_t> stack_args(nargs + 1);
+    stack_args[0] = callerAddress;
     for (int i = 0; i < nargs; ++i)
-    {
-        uintptr_t arg = va_arg(vl, uintptr_t);
-        if (!_pMemOp->Write(stack, &arg, sizeof(uintptr_t)))
-            return failure_return();
-        stack += sizeof(uintptr_t);
-    }
+        stack_args[i + 1] = va_arg(vl, uintptr_t);
 
-    // Push return address onto stack
-    tmp_regs.esp -= sizeof(uintptr_t);
-    if (!_pMemOp->Write(tmp_regs.esp, &callerAddress, sizeof(uintptr_t)))
+    size_t stack_size = sizeof(uintptr_t) * stack_args.size();
+    tmp_regs.esp -= stack_size;
+    if (_pMemOp->Write(tmp_regs.esp, stack_args.data(), stack_size) != stack_size)
         return failure_return();
 
     // Set function address to call
@@ -269,23 +263,15 @@ uintptr_t KittyTraceMgr::callFunctionFrom(uintptr_t callerAddress, uintptr_t fun
         }
     }
 
-    // Push remaining parameters onto stack
-    if (nargs > 6)
-    {
-        tmp_regs.rsp -= sizeof(uintptr_t) * (nargs - 6);
-        uintptr_t stack = tmp_regs.rsp;
-        for (int i = 6; i < nargs; ++i)
-        {
-            uintptr_t arg = va_arg(vl, uintptr_t);
-            if (!_pMemOp->Write(stack, &arg, sizeof(uintptr_t)))
-                return failure_return();
-            stack += sizeof(uintptr_t);
-        }
-    }
+    // Push return address followed by remaining parameters onto stack with a single write
+    std::vector<uintptr_t> stack_args(1 + (nargs > 6 ? nargs - 6 : 0));
+    stack_args[0] = callerAddress;
+    for (size_t i = 1; i < stack_args.size(); ++i)
+        stack_args[i] = va_arg(vl, uintptr_t);
 
-    // Push return address onto stack
-    tmp_regs.rsp -= sizeof(uintptr_t);
-    if (!_pMemOp->Write(tmp_regs.rsp, &callerAddress, sizeof(uintptr_t)))
+    size_t stack_size = sizeof(uintptr_t) * stack_args.size();
+    tmp_regs.rsp -= stack_size;
+    if (_pMemOp->Write(tmp_regs.rsp, stack_args.data(), stack_size) != stack_size)
         return failure_return();
 
     // Set function address to call
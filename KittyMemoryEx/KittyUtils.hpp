@@ -3,6 +3,7 @@
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #include <stdio.h>
 #include <fcntl.h>
@@ -12,6 +13,7 @@
 #include <cstring>
 #include <cstdint>
 #include <cstdarg>
+#include <climits>
 
 #include <string>
 #include <sstream>
@@ -22,6 +24,7 @@
 #include <utility>
 #include <map>
 #include <random>
+#include <functional>
 
 #include <elf.h>
 #ifdef __LP64__
@@ -139,6 +139,43 @@ MemoryPatch MemoryPatchMgr::createWithHex(const KittyMemoryEx::ProcMap &map, uin
   return createWithHex(map.startAddress + address, hex);
 }
 
+size_t MemoryPatchMgr::writeBatch(std::vector<MemoryPatch> &patches, bool restore) const
+{
+  if (!_pMem)
+    return 0;
+
+  std::vector<mem_request_t> requests;
+  requests.reserve(patches.size());
+  for (auto &it : patches)
+  {
+    if (!it.isValid())
+      continue;
+
+    uint8_t *code = restore ? &it._orig_code[0] : &it._patch_code[0];
+    requests.emplace_back(it._address, code, it._size);
+  }
+
+  _pMem->WriteBatch(requests);
+
+  size_t n = 0;
+  for (auto &it : requests)
+  {
+    if (it.result == it.len)
+      n++;
+  }
+  return n;
+}
+
+size_t MemoryPatchMgr::modifyBatch(std::vector<MemoryPatch> &patches) const
+{
+  return writeBatch(patches, false);
+}
+
+size_t MemoryPatchMgr::restoreBatch(std::vector<MemoryPatch> &patches) const
+{
+  return writeBatch(patches, true);
+}
+
 #ifndef kNO_KEYSTONE
 
 MemoryPatch MemoryPatchMgr::createWithAsm(uintptr_t absolute_address, MP_ASM_ARCH asm_arch, const std::string &asm_code, uintptr_t asm_address)
@@ -66,6 +66,8 @@ class MemoryPatchMgr
 private:
     IKittyMemOp *_pMem;
 
+    size_t writeBatch(std::vector<MemoryPatch> &patches, bool restore) const;
+
 public:
     MemoryPatchMgr() : _pMem(nullptr) {}
     MemoryPatchMgr(IKittyMemOp *pMem) : _pMem(pMem) {}
@@ -76,6 +78,18 @@ public:
     MemoryPatch createWithHex(uintptr_t absolute_address, std::string hex);
     MemoryPatch createWithHex(const KittyMemoryEx::ProcMap &map, uintptr_t address, const std::string &hex);
 
+    /*
+     * Applies all patches with batched writes
+     * Returns number of patches fully applied
+     */
+    size_t modifyBatch(std::vector<MemoryPatch> &patches) const;
+
+    /*
+     * Restores all patches with batched writes
+     * Returns number of patches fully restored
+     */
+    size_t restoreBatch(std::vector<MemoryPatch> &patches) const;
+
 #ifndef kNO_KEYSTONE
     /**
      * Keystone assembler
@@ -0,0 +1,514 @@
+#include "PointerScanner.hpp"
+#include "KittyScanner.hpp"
+
+#include <thread>
+#include <atomic>
+
+std::string pointer_path_t::toString() const
+{
+    std::string str = module;
+    for (size_t i = 0; i < offsets.size(); i++)
+        str += KittyUtils::String::Fmt(i ? " -> 0x%llx" : " + 0x%llx", (unsigned long long)offsets[i]);
+    return str;
+}
+
+bool pointer_path_t::fromString(const std::string &str, pointer_path_t *path)
+{
+    if (!path)
+        return false;
+
+    size_t plus = str.find(" + 0x");
+    if (plus == std::string::npos || !plus)
+        return false;
+
+    path->module = str.substr(0, plus);
+    path->moduleBase = 0;
+    path->offsets.clear();
+
+    const char *p = str.c_str() + plus + 3;
+    for (;;)
+    {
+        char *end = nullptr;
+        unsigned long long offset = strtoull(p, &end, 16);
+        if (end == p)
+            return false;
+
+        path->offsets.push_back(uintptr_t(offset));
+
+        if (!*end || *end == '\n' || *end == '\r')
+            return true;
+
+        if (strncmp(end, " -> 0x", 6) != 0)
+            return false;
+
+        p = end + 4;
+    }
+}
+
+void PointerScanner::findModules(const std::vector<KittyMemoryEx::ProcMap> &maps)
+{
+    _modules.clear();
+
+    std::vector<const KittyMemoryEx::ProcMap *> candidates;
+    for (auto &it : maps)
+    {
+        if (it.readable && !it.pathname.empty() && it.pathname[0] != '[')
+            candidates.push_back(&it);
+    }
+
+    // check ELF magic of all candidates at once
+    std::vector<uint32_t> magic(candidates.size(), 0);
+    std::vector<mem_request_t> requests;
+    requests.reserve(candidates.size());
+    for (size_t i = 0; i < candidates.size(); i++)
+        requests.emplace_back(uintptr_t(candidates[i]->startAddress), &magic[i], sizeof(uint32_t));
+
+    _pMem->ReadBatch(requests);
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        const uintptr_t start = uintptr_t(candidates[i]->startAddress);
+        if (!_modules.empty() && start < _modules.back().end)
+            continue;
+
+        if (requests[i].result != sizeof(uint32_t) || memcmp(&magic[i], "\177ELF", 4) != 0)
+            continue;
+
+        ElfScanner elf(_pMem, start);
+        if (!elf.loadSize())
+            continue;
+
+        _modules.push_back({elf.base(), elf.end(), KittyUtils::fileNameFromPath(candidates[i]->pathname)});
+    }
+}
+
+bool PointerScanner::snapshot(const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter,
+                              size_t alignment, size_t threads)
+{
+    if (!_pMem || _pMem->processID() < 1)
+        return false;
+
+    if (!alignment)
+        alignment = sizeof(uintptr_t);
+
+    if ((alignment & (alignment - 1)) || alignment > sizeof(uintptr_t))
+    {
+        KITTY_LOGE("PointerScanner: invalid alignment %d.", int(alignment));
+        return false;
+    }
+
+    clear();
+    _alignment = alignment;
+
+    const auto maps = KittyMemoryEx::getAllMaps(_pMem->processID());
+    if (maps.empty())
+        return false;
+
+    findModules(maps);
+
+    // readable ranges a pointer value may point into, adjacent ones merged
+    std::vector<uintptr_t> valid_starts, valid_ends;
+    // scanned units with room for a pointer crossing into the next unit
+    struct unit_t
+    {
+        uintptr_t start, end, readEnd;
+    };
+    std::vector<unit_t> units;
+
+    for (auto &it : maps)
+    {
+        if (it.readable)
+        {
+            if (!valid_ends.empty() && valid_ends.back() == uintptr_t(it.startAddress))
+                valid_ends.back() = uintptr_t(it.endAddress);
+            else
+                valid_starts.push_back(uintptr_t(it.startAddress)), valid_ends.push_back(uintptr_t(it.endAddress));
+        }
+
+        if (!it.readable || (filter ? !filter(it) : !it.writeable))
+            continue;
+
+        for (uintptr_t address = it.startAddress; address < it.endAddress; address += KT_SCAN_CHUNK_SIZE)
+        {
+            uintptr_t end = std::min(uintptr_t(it.endAddress), address + KT_SCAN_CHUNK_SIZE);
+            units.push_back({address, end, std::min(uintptr_t(it.endAddress), end + sizeof(uintptr_t) - 1)});
+        }
+    }
+
+    if (units.empty() || valid_starts.empty())
+        return true;
+
+    const uintptr_t valid_min = valid_starts.front(), valid_max = valid_ends.back();
+    auto is_valid = [&](uintptr_t value) -> bool
+    {
+        if (value < valid_min || value >= valid_max)
+            return false;
+
+        size_t i = std::upper_bound(valid_starts.begin(), valid_starts.end(), value) - valid_starts.begin();
+        return i && value < valid_ends[i - 1];
+    };
+
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min(threads, units.size());
+
+    std::vector<std::vector<pointer_entry_t>> locals(threads);
+    std::atomic<size_t> next_unit(0);
+
+    auto worker = [&](size_t t)
+    {
+        std::vector<uint8_t> buf(KT_SCAN_CHUNK_SIZE + sizeof(uintptr_t) - 1);
+        auto &local = locals[t];
+
+        for (size_t u = next_unit++; u < units.size(); u = next_unit++)
+        {
+            const unit_t &unit = units[u];
+            const size_t len = unit.readEnd - unit.start;
+            if (!_pMem->ReadMapped(unit.start, buf.data(), len, maps))
+                continue;
+
+            // pointers starting inside this unit
+            const size_t last = std::min(size_t(unit.end - unit.start), len - sizeof(uintptr_t) + 1);
+            for (size_t off = 0; len >= sizeof(uintptr_t) && off < last; off += alignment)
+            {
+                uintptr_t value;
+                memcpy(&value, &buf[off], sizeof(uintptr_t));
+                if (is_valid(value))
+                    local.push_back({value, unit.start + off});
+            }
+        }
+
+        // merge sort copes well with the long ascending runs typical for pointer arrays and lists
+        std::stable_sort(local.begin(), local.end());
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; i++)
+        pool.emplace_back(worker, i);
+    worker(0);
+    for (auto &th : pool)
+        th.join();
+
+    size_t total = 0;
+    for (auto &it : locals)
+        total += it.size();
+
+    _index.reserve(total);
+    for (auto &it : locals)
+    {
+        size_t mid = _index.size();
+        _index.insert(_index.end(), it.begin(), it.end());
+        std::inplace_merge(_index.begin(), _index.begin() + mid, _index.end());
+        std::vector<pointer_entry_t>().swap(it);
+    }
+
+    KITTY_LOGD("PointerScanner: indexed %zu pointers in %zu units, %zu modules.", _index.size(), units.size(), _modules.size());
+    return true;
+}
+
+size_t PointerScanner::scan(uintptr_t target, const pointer_scan_options_t &options,
+                            const std::function<bool(const pointer_path_t &)> &callback) const
+{
+    if (!_pMem || !target || !callback || _index.empty() || !options.maxDepth)
+        return 0;
+
+    if (options.maxOffset > UINT32_MAX)
+    {
+        KITTY_LOGE("PointerScanner: max offset is too large.");
+        return 0;
+    }
+
+    // static bases allowed by options
+    std::vector<bool> allowed(_modules.size(), options.modules.empty());
+    for (size_t i = 0; i < _modules.size(); i++)
+    {
+        for (auto &name : options.modules)
+        {
+            // module names are file names, full paths match by their file name
+            if (KittyUtils::String::EndsWith(_modules[i].name, name) ||
+                (name.find('/') != std::string::npos && _modules[i].name == KittyUtils::fileNameFromPath(name)))
+            {
+                allowed[i] = true;
+                break;
+            }
+        }
+    }
+
+    auto static_module = [&](uintptr_t address) -> int32_t
+    {
+        auto it = std::upper_bound(_modules.begin(), _modules.end(), address,
+                                   [](uintptr_t a, const module_t &m) { return a < m.start; });
+        if (it == _modules.begin())
+            return -1;
+
+        --it;
+        size_t i = it - _modules.begin();
+        return address < it->end && allowed[i] ? int32_t(i) : -1;
+    };
+
+    struct edge_t
+    {
+        uint32_t child;  // node index in the previous level
+        uint32_t offset; // child = [node] + offset
+    };
+
+    struct level_t
+    {
+        std::vector<uintptr_t> nodes;    // sorted
+        std::vector<int32_t> modules;    // static module of each node or -1
+        std::vector<uint32_t> edgeStart; // nodes.size() + 1
+        std::vector<edge_t> edges;
+    };
+
+    struct link_t
+    {
+        uintptr_t location;
+        uint32_t child;
+        uint32_t offset;
+    };
+
+    size_t threads = options.threads;
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::vector<level_t> levels(1);
+    levels[0].nodes.push_back(target);
+    levels[0].modules.push_back(-1);
+
+    bool truncated = false;
+    for (size_t depth = 0; depth < options.maxDepth; depth++)
+    {
+        const level_t &cur = levels.back();
+
+        // find pointers into [node - maxOffset, node] for every non static node
+        const size_t nthreads = std::min(threads, std::max(cur.nodes.size() / 64, size_t(1)));
+        std::vector<std::vector<link_t>> locals(nthreads);
+        std::atomic<size_t> next_node(0);
+        const size_t block = 256;
+
+        auto worker = [&](size_t t)
+        {
+            auto &local = locals[t];
+            for (size_t first = next_node.fetch_add(block); first < cur.nodes.size(); first = next_node.fetch_add(block))
+            {
+                const size_t last = std::min(first + block, cur.nodes.size());
+                for (size_t i = first; i < last; i++)
+                {
+                    if (cur.modules[i] >= 0)
+                        continue;
+
+                    const uintptr_t node = cur.nodes[i];
+                    const uintptr_t low = node > options.maxOffset ? node - options.maxOffset : 0;
+                    auto it = std::lower_bound(_index.begin(), _index.end(), low,
+                                               [](const pointer_entry_t &e, uintptr_t v) { return e.value < v; });
+                    for (; it != _index.end() && it->value <= node; ++it)
+                        local.push_back({it->location, uint32_t(i), uint32_t(node - it->value)});
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < nthreads; i++)
+            pool.emplace_back(worker, i);
+        worker(0);
+        for (auto &th : pool)
+            th.join();
+
+        std::vector<link_t> links;
+        for (auto &it : locals)
+        {
+            links.insert(links.end(), it.begin(), it.end());
+            std::vector<link_t>().swap(it);
+        }
+
+        if (links.empty())
+            break;
+
+        if (links.size() > options.maxLinksPerLevel)
+        {
+            std::nth_element(links.begin(), links.begin() + options.maxLinksPerLevel, links.end(),
+                             [](const link_t &a, const link_t &b) { return a.offset < b.offset; });
+            links.resize(options.maxLinksPerLevel);
+            truncated = true;
+        }
+
+        std::sort(links.begin(), links.end(), [](const link_t &a, const link_t &b)
+                  { return a.location < b.location || (a.location == b.location && a.child < b.child); });
+
+        levels.emplace_back();
+        level_t &next = levels.back();
+        next.edges.reserve(links.size());
+        for (size_t i = 0; i < links.size(); i++)
+        {
+            if (!i || links[i].location != links[i - 1].location)
+            {
+                next.nodes.push_back(links[i].location);
+                next.modules.push_back(static_module(links[i].location));
+                next.edgeStart.push_back(uint32_t(i));
+            }
+            next.edges.push_back({links[i].child, links[i].offset});
+        }
+        next.edgeStart.push_back(uint32_t(links.size()));
+    }
+
+    if (truncated)
+        KITTY_LOGW("PointerScanner: some levels exceeded %zu links, largest offsets were dropped.", options.maxLinksPerLevel);
+
+    // report paths, shorter ones first
+    size_t count = 0;
+    bool stop = false;
+    pointer_path_t path;
+
+    std::function<void(size_t, uint32_t)> walk = [&](size_t lvl, uint32_t node)
+    {
+        if (!lvl)
+        {
+            count++;
+            stop = !callback(path);
+            return;
+        }
+
+        const level_t &lv = levels[lvl];
+        for (uint32_t e = lv.edgeStart[node]; e < lv.edgeStart[node + 1] && !stop; e++)
+        {
+            path.offsets[path.offsets.size() - lvl] = lv.edges[e].offset;
+            walk(lvl - 1, lv.edges[e].child);
+        }
+    };
+
+    for (size_t lvl = 1; lvl < levels.size() && !stop; lvl++)
+    {
+        const level_t &lv = levels[lvl];
+        path.offsets.assign(lvl + 1, 0);
+        for (size_t i = 0; i < lv.nodes.size() && !stop; i++)
+        {
+            if (lv.modules[i] < 0)
+                continue;
+
+            const module_t &module = _modules[lv.modules[i]];
+            path.module = module.name;
+            path.moduleBase = module.start;
+            path.offsets[0] = lv.nodes[i] - module.start;
+            walk(lvl, uint32_t(i));
+        }
+    }
+
+    return count;
+}
+
+std::vector<pointer_path_t> PointerScanner::scan(uintptr_t target, const pointer_scan_options_t &options, size_t maxResults) const
+{
+    std::vector<pointer_path_t> results;
+    if (!maxResults)
+        return results;
+
+    scan(target, options, [&](const pointer_path_t &path)
+         {
+             results.push_back(path);
+             return results.size() < maxResults;
+         });
+
+    return results;
+}
+
+size_t PointerScanner::scanToFile(uintptr_t target, const pointer_scan_options_t &options, const std::string &path) const
+{
+    KittyIOFile file(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (!file.Open())
+    {
+        KITTY_LOGE("PointerScanner: failed to open file %s, error %s.", path.c_str(), file.lastStrError().c_str());
+        return 0;
+    }
+
+    std::string buf;
+    uintptr_t offset = 0;
+    bool failed = false;
+
+    auto flush = [&]() -> bool
+    {
+        if (buf.empty())
+            return true;
+
+        if (size_t(file.Write(offset, buf.data(), buf.size())) != buf.size())
+        {
+            KITTY_LOGE("PointerScanner: failed to write file %s, error %s.", path.c_str(), file.lastStrError().c_str());
+            return false;
+        }
+
+        offset += buf.size();
+        buf.clear();
+        return true;
+    };
+
+    size_t count = scan(target, options, [&](const pointer_path_t &p)
+                        {
+                            buf += p.toString();
+                            buf += '\n';
+                            if (buf.size() >= 0x100000 && !flush())
+                                failed = true;
+                            return !failed;
+                        });
+
+    if (!failed && !flush())
+        failed = true;
+
+    return failed ? 0 : count;
+}
+
+size_t PointerScanner::readFile(const std::string &path, const std::function<bool(const pointer_path_t &)> &callback)
+{
+    if (!callback)
+        return 0;
+
+    KittyIOFile file(path, O_RDONLY);
+    if (!file.Open())
+    {
+        KITTY_LOGE("PointerScanner: failed to open file %s, error %s.", path.c_str(), file.lastStrError().c_str());
+        return 0;
+    }
+
+    size_t count = 0;
+    uintptr_t offset = 0;
+    std::vector<char> buf(0x100000);
+    std::string line;
+    pointer_path_t p;
+
+    for (;;)
+    {
+        ssize_t n = file.Read(offset, buf.data(), buf.size());
+        if (n <= 0)
+            break;
+
+        offset += n;
+        for (ssize_t i = 0; i < n; i++)
+        {
+            if (buf[i] != '\n')
+            {
+                line += buf[i];
+                continue;
+            }
+
+            if (pointer_path_t::fromString(line, &p))
+            {
+                count++;
+                if (!callback(p))
+                    return count;
+            }
+            line.clear();
+        }
+    }
+
+    if (!line.empty() && pointer_path_t::fromString(line, &p))
+    {
+        count++;
+        callback(p);
+    }
+
+    return count;
+}
+
+void PointerScanner::clear()
+{
+    std::vector<pointer_entry_t>().swap(_index);
+    _modules.clear();
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "KittyUtils.hpp"
+#include "KittyMemoryEx.hpp"
+#include "KittyMemOp.hpp"
+
+/**
+ * Pointer path found by PointerScanner
+ * same layout as pointer_chain_t with base set to the module base,
+ * offsets[0] is the static slot offset from module base, every offset except the last one is dereferenced
+ */
+struct pointer_path_t
+{
+    std::string module;
+    uintptr_t moduleBase = 0;
+    std::vector<uintptr_t> offsets;
+
+    pointer_path_t() : moduleBase(0) {}
+
+    inline size_t depth() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    /**
+     * "libname.so + 0x1234 -> 0x10 -> 0x8"
+     */
+    std::string toString() const;
+
+    /**
+     * Parse a toString() line, moduleBase is left 0
+     */
+    static bool fromString(const std::string &str, pointer_path_t *path);
+};
+
+struct pointer_scan_options_t
+{
+    size_t maxDepth = 5;          // max number of dereferences after the static slot
+    uintptr_t maxOffset = 0x1000; // max offset added to each dereferenced pointer
+    size_t maxLinksPerLevel = size_t(1) << 22; // pointers found per level are capped, largest offsets are dropped first
+    size_t threads = 0;           // 0 for hardware concurrency
+    std::vector<std::string> modules; // only modules whose path ends with one of these are static bases, empty for all
+};
+
+/**
+ * Reverse pointer scanner
+ * snapshot() indexes every pointer stored in the scanned regions once, sorted by value,
+ * scans then walk back from the target one level at a time and report paths
+ * that start inside a loaded ELF (base to end, including its .bss)
+ */
+class PointerScanner
+{
+private:
+    struct pointer_entry_t
+    {
+        uintptr_t value;
+        uintptr_t location;
+
+        inline bool operator<(const pointer_entry_t &other) const { return value < other.value; }
+    };
+
+    struct module_t
+    {
+        uintptr_t start, end;
+        std::string name;
+    };
+
+    IKittyMemOp *_pMem;
+    size_t _alignment;
+    std::vector<pointer_entry_t> _index; // sorted by value
+    std::vector<module_t> _modules;      // sorted by start
+
+    void findModules(const std::vector<KittyMemoryEx::ProcMap> &maps);
+
+public:
+    PointerScanner() : _pMem(nullptr), _alignment(sizeof(uintptr_t)) {}
+    PointerScanner(IKittyMemOp *pMem) : _pMem(pMem), _alignment(sizeof(uintptr_t)) {}
+
+    inline bool isValid() const { return _pMem != nullptr; }
+
+    /**
+     * Read scanned regions and index all values that point into a readable region
+     * replaces any previous snapshot
+     *
+     * @param filter: optional, only regions it returns true for are indexed, default is readable & writable
+     * @param alignment: pointer alignment, power of 2, 0 for pointer size
+     * @param threads: number of threads, 0 for hardware concurrency
+     */
+    bool snapshot(const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter = nullptr,
+                  size_t alignment = 0, size_t threads = 0);
+
+    /**
+     * Number of indexed pointers
+     */
+    inline size_t pointerCount() const { return _index.size(); }
+
+    /**
+     * Number of ELF modules used as static bases
+     */
+    inline size_t moduleCount() const { return _modules.size(); }
+
+    /**
+     * Find paths from static bases to target, shorter paths are reported first
+     *
+     * @param callback: called for every path, return false to stop
+     * @return number of reported paths
+     */
+    size_t scan(uintptr_t target, const pointer_scan_options_t &options,
+                const std::function<bool(const pointer_path_t &)> &callback) const;
+
+    /**
+     * Find up to maxResults paths from static bases to target
+     */
+    std::vector<pointer_path_t> scan(uintptr_t target, const pointer_scan_options_t &options, size_t maxResults = 100000) const;
+
+    /**
+     * Stream all paths from static bases to target into a text file, one toString() line per path
+     * nothing is kept in memory so result count is only limited by disk space
+     *
+     * @return number of written paths
+     */
+    size_t scanToFile(uintptr_t target, const pointer_scan_options_t &options, const std::string &path) const;
+
+    /**
+     * Read paths written by scanToFile
+     *
+     * @param callback: called for every path, return false to stop
+     * @return number of read paths
+     */
+    static size_t readFile(const std::string &path, const std::function<bool(const pointer_path_t &)> &callback);
+
+    /**
+     * Drop snapshot
+     */
+    void clear();
+};
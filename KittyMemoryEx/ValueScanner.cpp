@@ -0,0 +1,486 @@
+#include "ValueScanner.hpp"
+#include "KittyScanner.hpp"
+
+static size_t valueTypeSize(EKittyValueType type)
+{
+    switch (type)
+    {
+    case EK_VALUE_I8:
+    case EK_VALUE_U8:
+        return 1;
+    case EK_VALUE_I16:
+    case EK_VALUE_U16:
+        return 2;
+    case EK_VALUE_I32:
+    case EK_VALUE_U32:
+    case EK_VALUE_F32:
+        return 4;
+    case EK_VALUE_I64:
+    case EK_VALUE_U64:
+    case EK_VALUE_F64:
+        return 8;
+    }
+    return 0;
+}
+
+static bool isRelativeCompare(EKittyValueCompare cmp)
+{
+    return cmp >= EK_VALUE_CHANGED;
+}
+
+template <typename T>
+static inline T fromRaw(uint64_t raw)
+{
+    T v;
+    memcpy(&v, &raw, sizeof(T));
+    return v;
+}
+
+template <typename T>
+static inline bool compareValue(EKittyValueCompare cmp, T v, T a, T b, T prev)
+{
+    switch (cmp)
+    {
+    case EK_VALUE_EXACT:
+        return v == a;
+    case EK_VALUE_NOT_EQUAL:
+        return v != a;
+    case EK_VALUE_GREATER:
+        return v > a;
+    case EK_VALUE_LESS:
+        return v < a;
+    case EK_VALUE_BETWEEN:
+        return a <= v && v <= b;
+    case EK_VALUE_UNKNOWN:
+        return true;
+    case EK_VALUE_CHANGED:
+        return v != prev;
+    case EK_VALUE_UNCHANGED:
+        return v == prev;
+    case EK_VALUE_INCREASED:
+        return v > prev;
+    case EK_VALUE_DECREASED:
+        return v < prev;
+    case EK_VALUE_INCREASED_BY:
+        return v == T(prev + a);
+    case EK_VALUE_DECREASED_BY:
+        return v == T(prev - a);
+    }
+    return false;
+}
+
+// every slot, branchless so the compiler can vectorize it
+template <typename T, typename F>
+static size_t compareAllSlots(const uint8_t *data, size_t slots, size_t alignment, uint64_t *bits, F match)
+{
+    size_t count = 0;
+    for (size_t base = 0; base < slots; base += 64)
+    {
+        const size_t n = std::min(size_t(64), slots - base);
+        uint64_t word = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            T v;
+            memcpy(&v, data + (base + j) * alignment, sizeof(T));
+            word |= uint64_t(match(v)) << j;
+        }
+        bits[base / 64] = word;
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+template <typename T>
+static size_t compareFirst(const uint8_t *data, size_t slots, size_t alignment, uint64_t *bits,
+                           EKittyValueCompare cmp, T a, T b)
+{
+    switch (cmp)
+    {
+    case EK_VALUE_EXACT:
+        return compareAllSlots<T>(data, slots, alignment, bits, [a](T v) { return v == a; });
+    case EK_VALUE_NOT_EQUAL:
+        return compareAllSlots<T>(data, slots, alignment, bits, [a](T v) { return v != a; });
+    case EK_VALUE_GREATER:
+        return compareAllSlots<T>(data, slots, alignment, bits, [a](T v) { return v > a; });
+    case EK_VALUE_LESS:
+        return compareAllSlots<T>(data, slots, alignment, bits, [a](T v) { return v < a; });
+    case EK_VALUE_BETWEEN:
+        return compareAllSlots<T>(data, slots, alignment, bits, [a, b](T v) { return a <= v && v <= b; });
+    case EK_VALUE_UNKNOWN:
+        return compareAllSlots<T>(data, slots, alignment, bits, [](T) { return true; });
+    default:
+        break;
+    }
+    return 0;
+}
+
+// only slots set in prevBits, prevValues holds their values in slot order
+template <typename T>
+static size_t compareNext(const uint8_t *data, size_t slots, size_t alignment, uint64_t *bits,
+                          EKittyValueCompare cmp, T a, T b, const uint64_t *prevBits, const uint8_t *prevValues)
+{
+    size_t count = 0, k = 0;
+    for (size_t w = 0; w * 64 < slots; w++)
+    {
+        uint64_t prev_word = prevBits[w], word = 0;
+        while (prev_word)
+        {
+            const int j = __builtin_ctzll(prev_word);
+            prev_word &= prev_word - 1;
+
+            // crosses into a page that is no longer readable
+            if (w * 64 + j >= slots)
+                break;
+
+            T v, prev;
+            memcpy(&v, data + (w * 64 + j) * alignment, sizeof(T));
+            memcpy(&prev, prevValues + (k++) * sizeof(T), sizeof(T));
+            if (compareValue<T>(cmp, v, a, b, prev))
+                word |= uint64_t(1) << j;
+        }
+        bits[w] = word;
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+template <typename T>
+static size_t comparePage(const uint8_t *data, size_t slots, size_t alignment, uint64_t *bits,
+                          EKittyValueCompare cmp, uint64_t a, uint64_t b, const uint64_t *prevBits, const uint8_t *prevValues)
+{
+    if (!prevBits)
+        return compareFirst<T>(data, slots, alignment, bits, cmp, fromRaw<T>(a), fromRaw<T>(b));
+
+    return compareNext<T>(data, slots, alignment, bits, cmp, fromRaw<T>(a), fromRaw<T>(b), prevBits, prevValues);
+}
+
+ValueScanner::ValueScanner(IKittyMemOp *pMem, EKittyValueType type, size_t alignment)
+    : _pMem(pMem), _type(type), _valueSize(valueTypeSize(type)), _alignment(alignment ? alignment : _valueSize),
+      _pageSize(KT_PAGE_SIZE), _slots(0), _words(0), _count(0), _scanned(false),
+      _pPageMap(nullptr), _pageMapGeneration(0)
+{
+    if (!_valueSize || _alignment > _valueSize || (_alignment & (_alignment - 1)))
+    {
+        KITTY_LOGE("ValueScanner: invalid value type %d or alignment %d.", int(type), int(alignment));
+        _valueSize = 0;
+        return;
+    }
+
+    _slots = _pageSize / _alignment;
+    _words = (_slots + 63) / 64;
+}
+
+void ValueScanner::addPage(uintptr_t page, const uint8_t *data, bool tailValid, EKittyValueCompare cmp,
+                           const uint64_t &a, const uint64_t &b, const uint64_t *prevBits, const uint8_t *prevValues)
+{
+    // without the next page bytes, values crossing the page end can't be read
+    const size_t slots = tailValid ? _slots : (_pageSize - _valueSize) / _alignment + 1;
+
+    const size_t bits_offset = _bitmaps.size();
+    _bitmaps.resize(bits_offset + _words, 0);
+    uint64_t *bits = &_bitmaps[bits_offset];
+
+    size_t count = 0;
+    switch (_type)
+    {
+    case EK_VALUE_I8:
+        count = comparePage<int8_t>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_I16:
+        count = comparePage<int16_t>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_I32:
+        count = comparePage<int32_t>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_I64:
+        count = comparePage<int64_t>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_U8:
+        count = comparePage<uint8_t>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_U16:
+        count = comparePage<uint16_t>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_U32:
+        count = comparePage<uint32_t>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_U64:
+        count = comparePage<uint64_t>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_F32:
+        count = comparePage<float>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    case EK_VALUE_F64:
+        count = comparePage<double>(data, slots, _alignment, bits, cmp, a, b, prevBits, prevValues);
+        break;
+    }
+
+    if (!count)
+    {
+        _bitmaps.resize(bits_offset);
+        return;
+    }
+
+    _pages.push_back(page);
+    _valueOffsets.push_back(_count);
+    _count += count;
+
+    // keep current values of candidates for relative next scans
+    size_t value_offset = _values.size();
+    _values.resize(value_offset + count * _valueSize);
+    for (size_t w = 0; w < _words; w++)
+    {
+        for (uint64_t word = bits[w]; word; word &= word - 1)
+        {
+            const size_t slot = w * 64 + __builtin_ctzll(word);
+            memcpy(&_values[value_offset], data + slot * _alignment, _valueSize);
+            value_offset += _valueSize;
+        }
+    }
+}
+
+bool ValueScanner::scan(bool first, EKittyValueCompare cmp, uint64_t a, uint64_t b,
+                        const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter)
+{
+    if (!isValid() || _pMem->processID() < 1)
+        return false;
+
+    const size_t page_size = _pageSize;
+    const size_t tail = _valueSize - 1;
+
+    if (first)
+    {
+        if (isRelativeCompare(cmp))
+        {
+            KITTY_LOGE("ValueScanner: compare %d needs a previous scan.", int(cmp));
+            return false;
+        }
+
+        reset();
+
+        // clear before reading so writes made while scanning are seen by the next scan
+        if (_pPageMap)
+            _pageMapGeneration = _pPageMap->clearSoftDirty();
+
+        const size_t chunk_pages = std::max(size_t(KT_SCAN_CHUNK_SIZE) / page_size, size_t(1));
+        std::vector<uint8_t> buf(chunk_pages * page_size + tail);
+        std::vector<bool> page_ok;
+        std::vector<mem_request_t> requests;
+
+        for (auto &it : KittyMemoryEx::getAllMaps(_pMem->processID()))
+        {
+            if (filter ? !filter(it) : !(it.readable && it.writeable))
+                continue;
+
+            for (uintptr_t address = it.startAddress; address < it.endAddress; address += chunk_pages * page_size)
+            {
+                const size_t npages = std::min(chunk_pages, size_t(it.endAddress - address) / page_size);
+                const size_t len = npages * page_size;
+                const size_t tail_len = std::min(tail, size_t(it.endAddress - (address + len)));
+
+                page_ok.assign(npages, true);
+                bool tail_ok = tail_len == tail;
+
+                if (_pMem->Read(address, buf.data(), len + tail_len) != len + tail_len)
+                {
+                    // find out which pages are readable
+                    requests.clear();
+                    for (size_t i = 0; i < npages; i++)
+                        requests.emplace_back(address + i * page_size, &buf[i * page_size], page_size);
+
+                    _pMem->ReadBatch(requests);
+                    for (size_t i = 0; i < npages; i++)
+                        page_ok[i] = requests[i].result == page_size;
+
+                    tail_ok = false;
+                }
+
+                for (size_t i = 0; i < npages; i++)
+                {
+                    if (page_ok[i])
+                        addPage(address + i * page_size, &buf[i * page_size], i + 1 < npages ? page_ok[i + 1] : tail_ok,
+                                cmp, a, b, nullptr, nullptr);
+                }
+            }
+        }
+
+        _scanned = true;
+        return true;
+    }
+
+    if (!_scanned)
+    {
+        KITTY_LOGE("ValueScanner: nextScan called before firstScan.");
+        return false;
+    }
+
+    if (cmp == EK_VALUE_UNKNOWN)
+    {
+        KITTY_LOGE("ValueScanner: unknown compare is first scan only.");
+        return false;
+    }
+
+    std::vector<uintptr_t> prev_pages;
+    std::vector<uint64_t> prev_bitmaps;
+    std::vector<size_t> prev_offsets;
+    std::vector<uint8_t> prev_values;
+    prev_pages.swap(_pages);
+    prev_bitmaps.swap(_bitmaps);
+    prev_offsets.swap(_valueOffsets);
+    prev_values.swap(_values);
+    _count = 0;
+
+    // pages written since the previous scan, value tails in the next page count too
+    std::vector<bool> dirty;
+    if (_pPageMap)
+    {
+        if (_pageMapGeneration && _pageMapGeneration == _pPageMap->generation())
+        {
+            std::vector<uintptr_t> query;
+            query.reserve(prev_pages.size() * (tail ? 2 : 1));
+            for (uintptr_t page : prev_pages)
+            {
+                if (query.empty() || query.back() != page)
+                    query.push_back(page);
+                if (tail)
+                    query.push_back(page + page_size);
+            }
+
+            std::vector<uint64_t> entries(query.size());
+            _pPageMap->readEntries(query.data(), query.size(), entries.data());
+
+            dirty.resize(prev_pages.size());
+            size_t q = 0;
+            for (size_t k = 0; k < prev_pages.size(); k++)
+            {
+                while (query[q] != prev_pages[k])
+                    q++;
+
+                dirty[k] = !KittyPageMap::isClean(entries[q]) || (tail && !KittyPageMap::isClean(entries[q + 1]));
+            }
+        }
+
+        // another user cleared in between (or never cleared), all pages count as dirty
+        _pageMapGeneration = _pPageMap->clearSoftDirty();
+    }
+
+    // re-read dirty candidate pages in batches, consecutive pages share one request
+    const size_t batch_pages = std::max(size_t(KT_SCAN_CHUNK_SIZE) / page_size, size_t(1));
+    std::vector<uint8_t> buf, clean_buf(page_size + tail);
+    std::vector<mem_request_t> runs;
+    std::vector<size_t> run_first;
+
+    for (size_t first_page = 0; first_page < prev_pages.size(); first_page += batch_pages)
+    {
+        const size_t last_page = std::min(first_page + batch_pages, prev_pages.size());
+
+        runs.clear();
+        run_first.clear();
+        size_t buf_len = 0, last_read = SIZE_MAX;
+        for (size_t k = first_page; k < last_page; k++)
+        {
+            if (!dirty.empty() && !dirty[k])
+                continue;
+
+            if (!runs.empty() && last_read + 1 == k && prev_pages[k] == prev_pages[k - 1] + page_size)
+            {
+                runs.back().len += page_size;
+                buf_len += page_size;
+                last_read = k;
+                continue;
+            }
+
+            if (!runs.empty())
+                buf_len += tail;
+
+            runs.emplace_back(prev_pages[k], (void *)buf_len, page_size + tail);
+            run_first.push_back(k);
+            buf_len += page_size;
+            last_read = k;
+        }
+        buf_len += tail;
+
+        buf.resize(buf_len);
+        for (auto &run : runs)
+            run.buffer = buf.data() + uintptr_t(run.buffer);
+
+        if (!runs.empty())
+            _pMem->ReadBatch(runs);
+
+        size_t r = 0;
+        for (size_t k = first_page; k < last_page; k++)
+        {
+            const uint64_t *prev_bits = &prev_bitmaps[k * _words];
+            const uint8_t *prev_vals = &prev_values[prev_offsets[k] * _valueSize];
+
+            if (!dirty.empty() && !dirty[k])
+            {
+                // unchanged page, rebuild candidate values from the previous scan
+                size_t v = 0;
+                for (size_t w = 0; w < _words; w++)
+                {
+                    for (uint64_t word = prev_bits[w]; word; word &= word - 1, v++)
+                        memcpy(&clean_buf[(w * 64 + __builtin_ctzll(word)) * _alignment], prev_vals + v * _valueSize, _valueSize);
+                }
+
+                addPage(prev_pages[k], clean_buf.data(), true, cmp, a, b, prev_bits, prev_vals);
+                continue;
+            }
+
+            while (r + 1 < runs.size() && run_first[r + 1] <= k)
+                r++;
+
+            const size_t i = k - run_first[r];
+            uint8_t *data = reinterpret_cast<uint8_t *>(runs[r].buffer);
+            size_t got = runs[r].len;
+
+            // a short run may have skipped any of its pages, not only trailing ones, redo each page alone
+            // page + tail spans two pages at most so a count below page_size means this page failed
+            if (runs[r].result < runs[r].len)
+                got = _pMem->Read(prev_pages[k], data + i * page_size, page_size + tail);
+
+            if (got < page_size)
+                continue;
+
+            addPage(prev_pages[k], data + i * page_size, got >= page_size + tail, cmp, a, b, prev_bits, prev_vals);
+        }
+    }
+
+    return true;
+}
+
+std::vector<uintptr_t> ValueScanner::results(size_t offset, size_t max) const
+{
+    std::vector<uintptr_t> out;
+    if (offset >= _count || !max)
+        return out;
+
+    out.reserve(std::min(max, _count - offset));
+    for (size_t k = 0; k < _pages.size() && out.size() < max; k++)
+    {
+        const size_t page_count = (k + 1 < _pages.size() ? _valueOffsets[k + 1] : _count) - _valueOffsets[k];
+        if (_valueOffsets[k] + page_count <= offset)
+            continue;
+
+        size_t index = _valueOffsets[k];
+        for (size_t w = 0; w < _words && out.size() < max; w++)
+        {
+            for (uint64_t word = _bitmaps[k * _words + w]; word && out.size() < max; word &= word - 1, index++)
+            {
+                if (index >= offset)
+                    out.push_back(_pages[k] + (w * 64 + __builtin_ctzll(word)) * _alignment);
+            }
+        }
+    }
+    return out;
+}
+
+void ValueScanner::reset()
+{
+    _pages.clear();
+    _bitmaps.clear();
+    _valueOffsets.clear();
+    _values.clear();
+    _count = 0;
+    _scanned = false;
+}
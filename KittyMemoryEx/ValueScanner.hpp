@@ -0,0 +1,175 @@
+#pragma once
+
+#include "KittyUtils.hpp"
+#include "KittyMemoryEx.hpp"
+#include "KittyMemOp.hpp"
+#include "KittyPageMap.hpp"
+
+enum EKittyValueType
+{
+    EK_VALUE_I8 = 0,
+    EK_VALUE_I16,
+    EK_VALUE_I32,
+    EK_VALUE_I64,
+    EK_VALUE_U8,
+    EK_VALUE_U16,
+    EK_VALUE_U32,
+    EK_VALUE_U64,
+    EK_VALUE_F32,
+    EK_VALUE_F64
+};
+
+enum EKittyValueCompare
+{
+    EK_VALUE_EXACT = 0,   // value == a
+    EK_VALUE_NOT_EQUAL,   // value != a
+    EK_VALUE_GREATER,     // value > a
+    EK_VALUE_LESS,        // value < a
+    EK_VALUE_BETWEEN,     // a <= value <= b
+    EK_VALUE_UNKNOWN,     // any value, first scan only
+    EK_VALUE_CHANGED,     // value != previous, next scan only
+    EK_VALUE_UNCHANGED,   // value == previous, next scan only
+    EK_VALUE_INCREASED,   // value > previous, next scan only
+    EK_VALUE_DECREASED,   // value < previous, next scan only
+    EK_VALUE_INCREASED_BY, // value == previous + a, next scan only
+    EK_VALUE_DECREASED_BY  // value == previous - a, next scan only
+};
+
+/**
+ * Typed value scanner with first scan / next scan refinement
+ * candidates are kept as one bitmap per page plus their packed last values,
+ * next scans only re-read pages that still have candidates
+ */
+class ValueScanner
+{
+private:
+    IKittyMemOp *_pMem;
+    EKittyValueType _type;
+    size_t _valueSize;
+    size_t _alignment;
+    size_t _pageSize;
+    size_t _slots;    // value slots per page
+    size_t _words;    // bitmap words per page
+
+    std::vector<uintptr_t> _pages;     // candidate pages, sorted
+    std::vector<uint64_t> _bitmaps;    // _words per page, one bit per slot
+    std::vector<size_t> _valueOffsets; // per page, index of its first value in _values
+    std::vector<uint8_t> _values;      // last values of candidates in address order
+    size_t _count;
+    bool _scanned;
+
+    KittyPageMap *_pPageMap;
+    uint32_t _pageMapGeneration; // soft-dirty generation cleared by the last scan
+
+    // compare and append a page, data holds page size + value size - 1 bytes
+    void addPage(uintptr_t page, const uint8_t *data, bool tailValid, EKittyValueCompare cmp,
+                 const uint64_t &a, const uint64_t &b, const uint64_t *prevBits, const uint8_t *prevValues);
+
+    bool scan(bool first, EKittyValueCompare cmp, uint64_t a, uint64_t b,
+              const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter);
+
+    template <typename T>
+    static inline uint64_t toRaw(T v)
+    {
+        uint64_t raw = 0;
+        memcpy(&raw, &v, sizeof(T) < sizeof(raw) ? sizeof(T) : sizeof(raw));
+        return raw;
+    }
+
+public:
+    ValueScanner() : _pMem(nullptr), _type(EK_VALUE_I32), _valueSize(0), _alignment(0), _pageSize(0), _slots(0), _words(0), _count(0), _scanned(false),
+                     _pPageMap(nullptr), _pageMapGeneration(0) {}
+
+    /**
+     * @param pMem: memory operation
+     * @param type: value type
+     * @param alignment: value alignment, power of 2 not larger than value size, 0 for value size
+     */
+    ValueScanner(IKittyMemOp *pMem, EKittyValueType type, size_t alignment = 0);
+
+    inline bool isValid() const { return _pMem && _valueSize; }
+
+    inline EKittyValueType type() const { return _type; }
+    inline size_t valueSize() const { return _valueSize; }
+    inline size_t alignment() const { return _alignment; }
+
+    /**
+     * Use soft-dirty tracking, next scans only re-read pages written since the previous scan
+     * and compare the other candidates against their last values, nullptr to disable
+     */
+    inline void setPageMap(KittyPageMap *pageMap)
+    {
+        _pPageMap = pageMap;
+        _pageMapGeneration = 0;
+    }
+
+    /**
+     * Scan readable & writable regions, replaces any previous results
+     * T must be the scanner value type
+     *
+     * @param cmp: comparison, relative ones are not allowed
+     * @param filter: optional, only regions it returns true for are scanned, default is readable & writable
+     */
+    template <typename T>
+    bool firstScan(EKittyValueCompare cmp, T a = T(), T b = T(),
+                   const std::function<bool(const KittyMemoryEx::ProcMap &)> &filter = nullptr)
+    {
+        if (sizeof(T) != _valueSize)
+        {
+            KITTY_LOGE("ValueScanner: value size mismatch %d != %d.", int(sizeof(T)), int(_valueSize));
+            return false;
+        }
+        return scan(true, cmp, toRaw(a), toRaw(b), filter);
+    }
+
+    /**
+     * Re-read pages with candidates and keep the ones matching cmp
+     * T must be the scanner value type
+     */
+    template <typename T>
+    bool nextScan(EKittyValueCompare cmp, T a = T(), T b = T())
+    {
+        if (sizeof(T) != _valueSize)
+        {
+            KITTY_LOGE("ValueScanner: value size mismatch %d != %d.", int(sizeof(T)), int(_valueSize));
+            return false;
+        }
+        return scan(false, cmp, toRaw(a), toRaw(b), nullptr);
+    }
+
+    /**
+     * Number of candidates
+     */
+    inline size_t count() const { return _count; }
+
+    /**
+     * Number of pages holding candidates
+     */
+    inline size_t pageCount() const { return _pages.size(); }
+
+    /**
+     * Candidate addresses in address order
+     */
+    std::vector<uintptr_t> results(size_t offset = 0, size_t max = SIZE_MAX) const;
+
+    /**
+     * Candidate values as of the last scan in address order, T must be the scanner value type
+     */
+    template <typename T>
+    std::vector<T> values(size_t offset = 0, size_t max = SIZE_MAX) const
+    {
+        std::vector<T> out;
+        if (sizeof(T) != _valueSize || offset >= _count)
+            return out;
+
+        size_t n = std::min(max, _count - offset);
+        out.resize(n);
+        memcpy(out.data(), _values.data() + offset * _valueSize, n * _valueSize);
+        return out;
+    }
+
+    /**
+     * Drop all candidates
+     */
+    void reset();
+};
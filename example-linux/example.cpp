@@ -39,12 +39,22 @@ int main(int argc, char *args[])
     KITTY_LOGI("================ GET ELF BASE ===============");
     
     ElfScanner g_libcElf{};
+    // watch maps so we only look for the library again when something got mapped or unmapped
+    KittyMemoryEx::MapsWatcher mapsWatcher(processID);
+    KittyMemoryEx::ProcMapsDiff mapsDiff;
     // loop until our target library is found
     do
     {
-        sleep(1);
-        // get loaded elf
-        g_libcElf = kittyMemMgr.getMemElf("libc.so");
+        if (mapsWatcher.update(&mapsDiff))
+        {
+            KITTY_LOGI("maps changed: added %zu, removed %zu, changed %zu.",
+                       mapsDiff.added.size(), mapsDiff.removed.size(), mapsDiff.changed.size());
+            // get loaded elf
+            g_libcElf = kittyMemMgr.getMemElf("libc.so");
+        }
+
+        if (!g_libcElf.isValid())
+            sleep(1);
     } while (!g_libcElf.isValid());
     
     uintptr_t libcBase = g_libcElf.base();
@@ -155,6 +165,10 @@ int main(int argc, char *args[])
     found_at_list = kittyMemMgr.memScanner.findIdaPatternAll(search_start, search_end, "33 ? 55 66 ? 77 88 ? 99");
     KITTY_LOGI("found ida pattern results: %zu", found_at_list.size());
 
+    // ida pattern checked at build time, each ? is one wildcard byte so ?? is two of them
+    found_at = kittyMemMgr.memScanner.findPatternFirst(search_start, search_end, KT_IDA_PATTERN("E8 ?? ?? ?? ?? 48 89"));
+    KITTY_LOGI("found build time ida pattern at: %p", (void *)found_at);
+
     // scan with data type & get one result
     uint32_t data = 0xdeadbeef;
     found_at = kittyMemMgr.memScanner.findDataFirst(search_start, search_end, &data, sizeof(data));
@@ -164,6 +178,13 @@ int main(int argc, char *args[])
     found_at_list = kittyMemMgr.memScanner.findDataAll(search_start, search_end, &data, sizeof(data));
     KITTY_LOGI("found data results: %zu", found_at_list.size());
 
+    // scan for several named patterns in one pass & get all results by name
+    PatternSet pattern_set;
+    pattern_set.add("ida", "33 ? 55 66 ? 77 88 ? 99");
+    pattern_set.add("data", "EF BE AD DE");
+    for (auto &it : kittyMemMgr.memScanner.findPatternSetAll(search_start, search_end, pattern_set))
+        KITTY_LOGI("found pattern set \"%s\" results: %zu", it.first.c_str(), it.second.size());
+
     KITTY_LOGI("====================== HEX DUMP =====================");
 
     // hex dump by default 8 rows with ASCII